@@ -0,0 +1,155 @@
+#include "allocationcounter.h"
+
+#include <cstdlib>
+#include <new>
+
+/****************************************************************
+ * Class 'AllocationCounter' and the global 'operator new' and
+ * 'operator delete' that it counts for.
+ *
+ * The operators get their memory from 'malloc', as the library
+ * ones do, and like them call the new handler and throw
+ * 'bad_alloc' when there is none. The array and 'nothrow' forms
+ * go through the plain ones, so everything is counted once.
+ *
+ * The flag is an ordinary 'bool' and should be set before other
+ * threads start. The counts for a thread are a 'thread_local'
+ * with no constructor, so counting takes no lock and never
+ * allocates itself.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+**/
+
+bool AllocationCounter::is_enabled_ = false;
+thread_local AllocationCounter::Counts AllocationCounter::thread_counts_ =
+    { 0, 0, 0 };
+std::atomic<LONG> AllocationCounter::total_allocations_(0);
+std::atomic<LONG> AllocationCounter::total_frees_(0);
+std::atomic<LONG> AllocationCounter::total_bytes_(0);
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Accessor for 'thread_counts_'.
+ *
+ * Returns:
+ *   the counts for the calling thread
+**/
+AllocationCounter::Counts AllocationCounter::GetThreadCounts() {
+  return thread_counts_;
+}
+
+/****************************************************************
+ * Function 'GetTotalCounts'.
+ *
+ * Returns:
+ *   the counts for all threads
+**/
+AllocationCounter::Counts AllocationCounter::GetTotalCounts() {
+  Counts counts;
+  counts.allocations = total_allocations_.load(std::memory_order_relaxed);
+  counts.frees = total_frees_.load(std::memory_order_relaxed);
+  counts.bytes = total_bytes_.load(std::memory_order_relaxed);
+  return counts;
+}
+
+/****************************************************************
+ * Accessor for 'is_enabled_'.
+**/
+bool AllocationCounter::IsEnabled() {
+  return is_enabled_;
+}
+
+/****************************************************************
+ * Mutator for 'is_enabled_'.
+**/
+void AllocationCounter::SetEnabled(bool value) {
+  is_enabled_ = value;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function 'CountAllocation', for 'operator new'.
+**/
+void AllocationCounter::CountAllocation(size_t size) {
+  if (is_enabled_) {
+    ++thread_counts_.allocations;
+    thread_counts_.bytes += size;
+    total_allocations_.fetch_add(1, std::memory_order_relaxed);
+    total_bytes_.fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+/****************************************************************
+ * Function 'CountFree', for 'operator delete'.
+**/
+void AllocationCounter::CountFree() {
+  if (is_enabled_) {
+    ++thread_counts_.frees;
+    total_frees_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/****************************************************************
+ * The global operators.
+**/
+void* operator new(std::size_t size) {
+  AllocationCounter::CountAllocation(size);
+  if (0 == size) {
+    size = 1;
+  }
+  while (true) {
+    void* memory = malloc(size);
+    if (NULL != memory) {
+      return memory;
+    }
+    std::new_handler handler = std::get_new_handler();
+    if (NULL == handler) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return operator new(size);
+  } catch (...) {
+    return NULL;
+  }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return operator new(size);
+  } catch (...) {
+    return NULL;
+  }
+}
+
+void operator delete(void* memory) noexcept {
+  if (NULL != memory) {
+    AllocationCounter::CountFree();
+    free(memory);
+  }
+}
+
+void operator delete[](void* memory) noexcept {
+  operator delete(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+  operator delete(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+  operator delete(memory);
+}
@@ -0,0 +1,57 @@
+/****************************************************************
+ * Header for the 'AllocationCounter' class.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+ * Linking 'allocationcounter.o' into a program replaces the global
+ * 'operator new' and 'operator delete' with ones that count every
+ * allocation and free, and its bytes, once counting is switched
+ * on. The counts are kept for each thread and for the program.
+ * With counting off the operators cost one test of a flag more
+ * than 'malloc' and 'free'.
+**/
+
+#ifndef ALLOCATIONCOUNTER_H_
+#define ALLOCATIONCOUNTER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+typedef int64_t LONG;
+
+class AllocationCounter {
+public:
+/****************************************************************
+ * What has been counted, since counting was first switched on.
+**/
+  struct Counts {
+    LONG allocations;
+    LONG frees;
+    LONG bytes;
+  };
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+  static Counts GetThreadCounts();
+  static Counts GetTotalCounts();
+  static bool IsEnabled();
+  static void SetEnabled(bool value);
+
+/****************************************************************
+ * General functions, for the operators.
+**/
+  static void CountAllocation(size_t size);
+  static void CountFree();
+
+private:
+  static bool is_enabled_;
+  static thread_local Counts thread_counts_;
+  static std::atomic<LONG> total_allocations_;
+  static std::atomic<LONG> total_frees_;
+  static std::atomic<LONG> total_bytes_;
+};
+
+#endif // ALLOCATIONCOUNTER_H_
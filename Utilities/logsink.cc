@@ -0,0 +1,311 @@
+#include "logsink.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+/****************************************************************
+ * Class 'LogSink' for the log file.
+ *
+ * Nearly every line written to the log ends with 'endl', and an
+ * 'ofstream' makes a system call for every one of them. A 'LogSink'
+ * keeps the text in a large buffer instead and writes it out only
+ * when the buffer fills, when 'kFlushMilliseconds' have passed since
+ * the last write at an 'endl' or 'flush', or when 'Flush' or 'close'
+ * is called. The destructor closes the log, so the text is also
+ * written out when the program calls 'exit'.
+ *
+ * With 'StartWriterThread' the writes themselves are done by a
+ * second thread, and the buffer that is being written is swapped for
+ * an empty one so that the program can go on logging meanwhile.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+**/
+
+/****************************************************************
+ * Constructor.
+**/
+LogSinkBuffer::LogSinkBuffer() {
+  fd_ = -1;
+  flush_milliseconds_ = kFlushMilliseconds;
+  bytes_handed_off_ = 0;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &last_hand_off_);
+  is_writer_running_ = false;
+  is_stopping_ = false;
+  pending_size_ = 0;
+  this->setp(NULL, NULL);
+}
+
+/****************************************************************
+ * Destructor.
+**/
+LogSinkBuffer::~LogSinkBuffer() {
+  this->Close();
+}
+
+/****************************************************************
+ * General functions.
+**/
+
+/****************************************************************
+ * Write out everything and close the file.
+**/
+void LogSinkBuffer::Close() {
+  if (fd_ < 0) {
+    return;
+  }
+  this->HandOff();
+  this->StopWriterThread();
+  ::close(fd_);
+  fd_ = -1;
+  this->setp(NULL, NULL);
+}
+
+/****************************************************************
+ * Write out everything now, and wait for it to be written.
+**/
+void LogSinkBuffer::Flush() {
+  if (fd_ < 0) {
+    return;
+  }
+  this->HandOff();
+  if (is_writer_running_) {
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    while (pending_size_ > 0) {
+      writer_changed_.wait(lock);
+    }
+  }
+}
+
+/****************************************************************
+ * Pass the buffer to be written, either to the writer thread or
+ * straight to the file.
+**/
+void LogSinkBuffer::HandOff() {
+  size_t how_many = this->pptr() - this->pbase();
+  if (how_many > 0) {
+    if (is_writer_running_) {
+      std::unique_lock<std::mutex> lock(writer_mutex_);
+      while (pending_size_ > 0) {
+        writer_changed_.wait(lock);
+      }
+      buffer_.swap(pending_);
+      pending_size_ = how_many;
+      writer_changed_.notify_all();
+    } else {
+      this->WriteAll(this->pbase(), how_many);
+    }
+    bytes_handed_off_ += how_many;
+  }
+
+  buffer_.resize(kBufferSize);
+  this->setp(&buffer_[0], &buffer_[0] + buffer_.size());
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &last_hand_off_);
+}
+
+/****************************************************************
+ * Is there a file open?
+**/
+bool LogSinkBuffer::IsOpen() const {
+  return fd_ >= 0;
+}
+
+/****************************************************************
+ * Open the file, replacing anything in it.
+ *
+ * Parameters:
+ *   filename - the name of the file
+ * Return: false if the file can't be opened
+**/
+bool LogSinkBuffer::Open(const std::string filename) {
+  this->Close();
+  fd_ = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    return false;
+  }
+  bytes_handed_off_ = 0;
+  buffer_.resize(kBufferSize);
+  this->setp(&buffer_[0], &buffer_[0] + buffer_.size());
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &last_hand_off_);
+  return true;
+}
+
+/****************************************************************
+ * The buffer is full, so pass it on and start a new one.
+**/
+LogSinkBuffer::int_type LogSinkBuffer::overflow(int_type c) {
+  if (fd_ < 0) {
+    return traits_type::eof();
+  }
+  this->HandOff();
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *this->pptr() = traits_type::to_char_type(c);
+    this->pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+/****************************************************************
+ * The only position asked for is the current one, by 'tellp', which
+ * is the number of bytes written so far.
+**/
+LogSinkBuffer::pos_type LogSinkBuffer::seekoff(off_type offset,
+                                               std::ios_base::seekdir direction,
+                                               std::ios_base::openmode which) {
+  if ((offset != 0) || (direction != std::ios_base::cur) ||
+      !(which & std::ios_base::out)) {
+    return pos_type(off_type(-1));
+  }
+  return pos_type(bytes_handed_off_ + (this->pptr() - this->pbase()));
+}
+
+/****************************************************************
+ * Set how long text may wait in the buffer before an 'endl' writes
+ * it out.
+**/
+void LogSinkBuffer::SetFlushMilliseconds(int milliseconds) {
+  flush_milliseconds_ = milliseconds;
+}
+
+/****************************************************************
+ * Start a thread to do the writes.
+**/
+void LogSinkBuffer::StartWriterThread() {
+  if (is_writer_running_) {
+    return;
+  }
+  is_stopping_ = false;
+  is_writer_running_ = true;
+  writer_ = std::thread(&LogSinkBuffer::WriterLoop, this);
+}
+
+/****************************************************************
+ * Stop the writer thread once it has written what it was given.
+**/
+void LogSinkBuffer::StopWriterThread() {
+  if (!is_writer_running_) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    is_stopping_ = true;
+    writer_changed_.notify_all();
+  }
+  writer_.join();
+  is_writer_running_ = false;
+}
+
+/****************************************************************
+ * This is called at every 'endl' and 'flush'. Rather than write
+ * every time, we write only if the text has waited long enough.
+**/
+int LogSinkBuffer::sync() {
+  if (fd_ < 0) {
+    return 0;
+  }
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+  long long elapsed = (now.tv_sec - last_hand_off_.tv_sec) * 1000LL +
+                      (now.tv_nsec - last_hand_off_.tv_nsec) / 1000000;
+  if (elapsed >= flush_milliseconds_) {
+    this->HandOff();
+  }
+  return 0;
+}
+
+/****************************************************************
+ * Write all of the bytes, however many calls it takes.
+**/
+void LogSinkBuffer::WriteAll(const char* bytes, size_t how_many) {
+  while (how_many > 0) {
+    ssize_t written = ::write(fd_, bytes, how_many);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    bytes += written;
+    how_many -= written;
+  }
+}
+
+/****************************************************************
+ * The body of the writer thread.
+**/
+void LogSinkBuffer::WriterLoop() {
+  std::unique_lock<std::mutex> lock(writer_mutex_);
+  while (true) {
+    if (pending_size_ > 0) {
+      size_t how_many = pending_size_;
+      lock.unlock();
+      this->WriteAll(&pending_[0], how_many);
+      lock.lock();
+      pending_size_ = 0;
+      writer_changed_.notify_all();
+    } else if (is_stopping_) {
+      break;
+    } else {
+      writer_changed_.wait(lock);
+    }
+  }
+}
+
+/****************************************************************
+ * Constructor.
+**/
+LogSink::LogSink() : std::ostream(NULL) {
+  this->rdbuf(&buffer_);
+}
+
+/****************************************************************
+ * Destructor.
+**/
+LogSink::~LogSink() {
+  buffer_.Close();
+}
+
+/****************************************************************
+ * General functions.
+**/
+
+/****************************************************************
+ * The 'ofstream' functions.
+**/
+void LogSink::close() {
+  buffer_.Close();
+}
+
+bool LogSink::is_open() const {
+  return buffer_.IsOpen();
+}
+
+void LogSink::open(const char* filename) {
+  if (buffer_.Open(filename)) {
+    this->clear();
+  } else {
+    this->setstate(std::ios_base::failbit);
+  }
+}
+
+/****************************************************************
+ * Write out everything now. Unlike 'flush', this does not wait for
+ * the time to have passed, so it is for faults and for exit.
+**/
+void LogSink::Flush() {
+  buffer_.Flush();
+}
+
+/****************************************************************
+ * Set how long text may wait in the buffer before an 'endl' writes
+ * it out.
+**/
+void LogSink::SetFlushMilliseconds(int milliseconds) {
+  buffer_.SetFlushMilliseconds(milliseconds);
+}
+
+/****************************************************************
+ * Do the writes on a second thread.
+**/
+void LogSink::StartWriterThread() {
+  buffer_.StartWriterThread();
+}
@@ -0,0 +1,98 @@
+/****************************************************************
+ * Header for the 'LogSink' class, a buffered log file stream.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+**/
+
+#ifndef LOGSINK_H_
+#define LOGSINK_H_
+
+#include <iostream>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+
+/****************************************************************
+ * The stream buffer behind a 'LogSink'.
+**/
+class LogSinkBuffer : public std::streambuf {
+public:
+  static const int kBufferSize = 1 << 20;
+  static const int kFlushMilliseconds = 1000;
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+  LogSinkBuffer();
+  virtual ~LogSinkBuffer();
+
+/****************************************************************
+ * General functions.
+**/
+  void Close();
+  void Flush();
+  bool IsOpen() const;
+  bool Open(const std::string filename);
+  void SetFlushMilliseconds(int milliseconds);
+  void StartWriterThread();
+  void StopWriterThread();
+
+protected:
+  virtual int_type overflow(int_type c);
+  virtual pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+                           std::ios_base::openmode which);
+  virtual int sync();
+
+private:
+  int fd_;
+  int flush_milliseconds_;
+  long long bytes_handed_off_;
+  struct timespec last_hand_off_;
+  std::vector<char> buffer_;
+
+  bool is_writer_running_;
+  bool is_stopping_;
+  std::thread writer_;
+  std::mutex writer_mutex_;
+  std::condition_variable writer_changed_;
+  std::vector<char> pending_;
+  size_t pending_size_;
+
+  void HandOff();
+  void WriteAll(const char* bytes, size_t how_many);
+  void WriterLoop();
+};
+
+/****************************************************************
+ * An output stream for the log file that does not flush at every
+ * 'endl', with the few 'ofstream' functions the programs use.
+**/
+class LogSink : public std::ostream {
+public:
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+  LogSink();
+  virtual ~LogSink();
+
+/****************************************************************
+ * General functions.
+**/
+  void close();
+  bool is_open() const;
+  void open(const char* filename);
+
+  void Flush();
+  void SetFlushMilliseconds(int milliseconds);
+  void StartWriterThread();
+
+private:
+  LogSinkBuffer buffer_;
+};
+
+#endif // LOGSINK_H_
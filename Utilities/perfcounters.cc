@@ -0,0 +1,206 @@
+#include "perfcounters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/****************************************************************
+ * Class 'PerfCounters' for the hardware counters of one thread.
+ *
+ * The counters count only in user mode, for this thread, on any
+ * CPU it runs on. They are opened as one group with the first one
+ * that opens as the leader. With more counters than the machine
+ * has registers the kernel takes turns among groups, so what a
+ * 'read' returns is scaled up by the time the group was enabled
+ * over the time it was counting.
+ *
+ * 'Open' fails only if no counter at all can be opened, as when
+ * 'perf_event_paranoid' forbids it, under a hypervisor that hides
+ * the counters, or with no 'perf_event_open' at all.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+**/
+
+const char* PerfCounters::kNames[PerfCounters::kHowMany] = {
+  "instructions", "cycles", "branch misses", "cache misses", "page faults"
+};
+
+/****************************************************************
+ * Constructor.
+**/
+PerfCounters::PerfCounters() {
+  leader_ = -1;
+  how_many_open_ = 0;
+  for (int counter = 0; counter < kHowMany; ++counter) {
+    descriptors_[counter] = -1;
+    positions_[counter] = -1;
+  }
+  error_ = "";
+}
+
+/****************************************************************
+ * Destructor.
+**/
+PerfCounters::~PerfCounters() {
+  this->Close();
+}
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Accessor for 'error_'.
+ *
+ * Returns:
+ *   the counters that would not open and why the first would not,
+ *   or ""
+**/
+std::string PerfCounters::GetError() const {
+  return error_;
+}
+
+/****************************************************************
+ * Function 'IsAvailable'.
+ *
+ * Returns:
+ *   true if 'counter' is open and counting
+**/
+bool PerfCounters::IsAvailable(int counter) const {
+  return positions_[counter] >= 0;
+}
+
+/****************************************************************
+ * Function 'IsOpen'.
+ *
+ * Returns:
+ *   true if any counter is open
+**/
+bool PerfCounters::IsOpen() const {
+  return how_many_open_ > 0;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function 'Close'.
+**/
+void PerfCounters::Close() {
+  for (int counter = 0; counter < kHowMany; ++counter) {
+    if (descriptors_[counter] >= 0) {
+      close(descriptors_[counter]);
+    }
+    descriptors_[counter] = -1;
+    positions_[counter] = -1;
+  }
+  leader_ = -1;
+  how_many_open_ = 0;
+}
+
+/****************************************************************
+ * Function 'Open', to open the counters for the calling thread
+ * and start them.
+ *
+ * Returns:
+ *   true if any counter could be opened
+**/
+bool PerfCounters::Open() {
+  static const unsigned int kTypes[kHowMany] = {
+    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE
+  };
+  static const unsigned long long kConfigs[kHowMany] = {
+    PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_SW_PAGE_FAULTS
+  };
+
+  this->Close();
+  error_ = "";
+  std::string reason = "";
+  for (int counter = 0; counter < kHowMany; ++counter) {
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = kTypes[counter];
+    attributes.config = kConfigs[counter];
+    attributes.disabled = (leader_ < 0) ? 1 : 0;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP |
+                             PERF_FORMAT_TOTAL_TIME_ENABLED |
+                             PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int descriptor = static_cast<int>(syscall(SYS_perf_event_open,
+                                              &attributes, 0, -1, leader_,
+                                              0));
+    if (descriptor < 0) {
+      if (reason == "") {
+        reason = strerror(errno);
+      }
+      if (error_ != "") {
+        error_ += ", ";
+      }
+      error_ += kNames[counter];
+      continue;
+    }
+    descriptors_[counter] = descriptor;
+    positions_[counter] = how_many_open_;
+    ++how_many_open_;
+    if (leader_ < 0) {
+      leader_ = descriptor;
+    }
+  }
+
+  if (error_ != "") {
+    error_ += ": " + reason;
+  }
+  if (leader_ < 0) {
+    return false;
+  }
+  ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+}
+
+/****************************************************************
+ * Function 'Read', for the counts since 'Open'. A counter that
+ * is not open reads as zero.
+ *
+ * Parameters:
+ *   counts - where to put the counts, indexed by 'kInstructions'
+ *            and the rest
+ * Returns:
+ *   false if the counters could not be read
+**/
+bool PerfCounters::Read(LONG counts[kHowMany]) const {
+  for (int counter = 0; counter < kHowMany; ++counter) {
+    counts[counter] = 0;
+  }
+  if (leader_ < 0) {
+    return false;
+  }
+
+  // What comes back is how many, the time enabled, the time
+  // running, and then the values in the order they were opened.
+  uint64_t values[3 + kHowMany];
+  ssize_t how_many_bytes = read(leader_, values, sizeof(values));
+  if (how_many_bytes < static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+    return false;
+  }
+  double scale = 1.0;
+  if ((values[2] > 0) && (values[2] < values[1])) {
+    scale = static_cast<double>(values[1]) / static_cast<double>(values[2]);
+  }
+  for (int counter = 0; counter < kHowMany; ++counter) {
+    int position = positions_[counter];
+    if ((position >= 0) && (position < static_cast<int>(values[0]))) {
+      counts[counter] = static_cast<LONG>(scale * values[3 + position]);
+    }
+  }
+  return true;
+}
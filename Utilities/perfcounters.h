@@ -0,0 +1,70 @@
+/****************************************************************
+ * Header for the 'PerfCounters' class.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+ * A 'PerfCounters' is a set of Linux 'perf_event_open' counters
+ * for the thread that opens it: instructions retired, cycles,
+ * branch misses, and cache misses from the hardware, and page
+ * faults from the kernel. A counter the machine or the kernel
+ * won't give us is left out and reads as zero, so a program can
+ * ask for counters without knowing whether it will get them.
+**/
+
+#ifndef PERFCOUNTERS_H_
+#define PERFCOUNTERS_H_
+
+#include <string>
+
+typedef int64_t LONG;
+
+class PerfCounters {
+public:
+  static const int kInstructions = 0;
+  static const int kCycles = 1;
+  static const int kBranchMisses = 2;
+  static const int kCacheMisses = 3;
+  static const int kPageFaults = 4;
+  static const int kHowMany = 5;
+
+  static const char* kNames[kHowMany];
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+  PerfCounters();
+  virtual ~PerfCounters();
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+  std::string GetError() const;
+  bool IsAvailable(int counter) const;
+  bool IsOpen() const;
+
+/****************************************************************
+ * General functions.
+**/
+  void Close();
+  bool Open();
+  bool Read(LONG counts[kHowMany]) const;
+
+private:
+/****************************************************************
+ * The counters are one group, so that one 'read' of the leader
+ * gets them all, counted over the same time. 'positions_' is
+ * where each counter is in what the 'read' returns, -1 if it is
+ * not open.
+**/
+  int leader_;
+  int how_many_open_;
+  int descriptors_[kHowMany];
+  int positions_[kHowMany];
+  std::string error_;
+
+  PerfCounters(const PerfCounters& that);
+  PerfCounters& operator=(const PerfCounters& that);
+};
+
+#endif // PERFCOUNTERS_H_
@@ -3,6 +3,7 @@
 using namespace std;
 
 // static const string TAG = "ScanLine: ";
+static const std::string kTag = "SCANLINE: ";
 
 // ifstream Utils::inStream; // deprecated
 // ofstream Utils::outStream; // deprecated
@@ -12,10 +13,18 @@ using namespace std;
 
 //stringstream ScanLine::myss;
 
+/****************************************************************
+ * A 'ScanLine' keeps its own copy of the line and lets the
+ * 'Tokenizer' find the tokens in it, so a token costs a search
+ * and the copy into the 'string' that is returned, and no stream
+ * extraction.
+**/
+
 /****************************************************************
  * Constructor.
 **/
 ScanLine::ScanLine() {
+  parse_error_ = Utils::kParseOK;
 }
 /****************************************************************
  * Destructor.
@@ -23,9 +32,34 @@ ScanLine::ScanLine() {
 ScanLine::~ScanLine() {
 }
 
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Accessor for 'parse_error_'.
+ *
+ * Returns:
+ *   the error from the last 'NextDouble', 'NextInt', or 'NextLONG'
+**/
+Utils::ParseError ScanLine::GetParseError() const {
+  return parse_error_;
+}
+
 /****************************************************************
  * General functions.
 **/
+/****************************************************************
+ * Function 'CheckParse' to keep the error from parsing a token,
+ * and log it if there is one.
+**/
+void ScanLine::CheckParse(StringView token, Utils::ParseError error) {
+  parse_error_ = error;
+  if ((Utils::kParseOK != error) && (Utils::kParseEmpty != error)) {
+    Utils::log_stream << kTag << "ERROR: token '" << token << "' "
+                      << Utils::ParseErrorName(error) << "\n";
+  }
+}
+
 /****************************************************************
  * Function 'HasMoreData'.
  *
@@ -38,9 +72,7 @@ bool ScanLine::HasMoreData() {
   Utils::logStream << TAG << "enter HasMoreData" << std::endl;
 #endif
   
-  if(scanline_ss_.eof()) {
-    return_value = false;
-  }
+  return_value = tokenizer_.HasMoreData();
 
 #ifdef EBUGS
   Utils::logStream << TAG << "leave HasMoreData '" << return_value << "'" << std::endl;
@@ -53,7 +85,7 @@ bool ScanLine::HasMoreData() {
  * Function 'HasNext'.
  *
  * Returns:
- *   true if there are ANY more characters in the input 'string'
+ *   true if there is another token in the input 'string'
 **/
 bool ScanLine::HasNext() {
   bool return_value = true;
@@ -61,9 +93,7 @@ bool ScanLine::HasNext() {
   Utils::logStream << TAG << "enter HasNext" << std::endl;
 #endif
   
-  if(scanline_ss_.eof()) {
-    return_value = false;
-  }
+  return_value = tokenizer_.HasNext();
 
 #ifdef EBUGS
   Utils::logStream << TAG << "leave HasNext '" << return_value << "'" << std::endl;
@@ -82,8 +112,8 @@ void ScanLine::OpenString(std::string line) {
   Utils::logStream << TAG << "enter OpenString '" << line << "'" << std::endl;
 #endif
   
-  scanline_ss_.clear();
-  scanline_ss_.str(line);
+  line_ = line;
+  tokenizer_.Open(line_);
 
 #ifdef EBUGS
   Utils::logStream << TAG << "leave OpenString" << std::endl;
@@ -107,10 +137,7 @@ string ScanLine::Next() {
   Utils::logStream << TAG << "enter next" << std::endl;
 #endif
   
-  token = "";
-  if(!scanline_ss_.eof()) {
-    scanline_ss_ >> token;
-  }
+  token = tokenizer_.Next().ToString();
 
 #ifdef EBUGS
   Utils::logStream << TAG << "leave next '" << token << "'" << std::endl;
@@ -122,8 +149,8 @@ string ScanLine::Next() {
 /****************************************************************
  * Function 'NextDouble' to return the next double.
  *
- * This function does not really trap erorrs. Errors converting
- * from 'string' to 'double' simply cause crashing.
+ * A token that is not a number, or no token, gives zero, and
+ * 'GetParseError' says which.
  *
  * Returns:
  *   the next token in the file, parsed as a 'double'
@@ -135,9 +162,10 @@ double ScanLine::NextDouble() {
   Utils::logStream << TAG << "enter NextDouble" << std::endl;
 #endif
   
-  if(!scanline_ss_.eof()) {
-    scanline_ss_ >> local_double;
-  }
+  StringView token = tokenizer_.Next();
+  Utils::Parsed<double> parsed = Utils::ParseDouble(token);
+  this->CheckParse(token, parsed.error);
+  local_double = parsed.value;
 
 #ifdef EBUGS
   Utils::logStream << TAG << "leave NextDouble '" << nextValue << "'" << std::endl;
@@ -149,24 +177,23 @@ double ScanLine::NextDouble() {
 /****************************************************************
  * Function 'NextInt' to return the next integer.
  *
- * This function does not really trap erorrs. Errors converting
- * from 'string' to 'int' simply cause crashing.
+ * A token that is not an 'int', or no token, gives zero, and
+ * 'GetParseError' says which.
  *
  * Returns:
  *   the next token in the file, parsed as an 'int'
 **/
 int ScanLine::NextInt() {
   int next_value = 0;
-  std::string token = "";
 
 #ifdef EBUGS
   Utils::logStream << TAG << "enter NextInt" << std::endl;
 #endif
   
-  if(!scanline_ss_.eof()) {
-    scanline_ss_ >> token;
-    next_value = Utils::StringToInteger(token); 
-  }
+  StringView token = tokenizer_.Next();
+  Utils::Parsed<int> parsed = Utils::ParseInt(token);
+  this->CheckParse(token, parsed.error);
+  next_value = parsed.value;
 
 #ifdef EBUGS
   Utils::logStream << TAG << "leave NextInt '" << NextValue << "'" << std::endl;
@@ -178,30 +205,20 @@ int ScanLine::NextInt() {
 /****************************************************************
  * Function 'NextLine' to return the rest of the line.
  *
- * This is just a wrapper for the 'getline' function.
  * Note that this does not trim whitespace at the beginning
  * or at the end.
  *
- * CAVEAT: We have put a max of 1024 characters that can be
- *         parsed with this function.
- *
  * Returns:
  *   the 'string' version of the rest of the line
 **/
 string ScanLine::NextLine() {
-  char xx[1025];
   std::string token;
 
 #ifdef EBUGS
   Utils::logStream << TAG << "enter NextLine" << std::endl;
 #endif
   
-  if (scanline_ss_.eof()) {
-    token = "";
-  } else {
-    scanline_ss_.getline(xx,1024);
-    token = string(xx);
-  }
+  token = tokenizer_.NextLine().ToString();
 
 #ifdef EBUGS
   Utils::logStream << TAG << "leave NextLine '" << token << "'" << std::endl;
@@ -213,24 +230,23 @@ string ScanLine::NextLine() {
 /****************************************************************
  * Function 'nextLONG' to return the next LONG.
  *
- * This function does not really trap errors. Errors converting
- * from 'string' to 'LONG' simply cause crashing.
+ * A token that is not a 'LONG', or no token, gives zero, and
+ * 'GetParseError' says which.
  *
  * Returns:
  *   the next token in the file, parsed as a 'LONG'
 **/
 LONG ScanLine::NextLONG() {
   LONG next_value = 0;
-  std::string token = "";
 
 #ifdef EBUGS
   Utils::logStream << TAG << "enter NextLONG" << std::endl;
 #endif
   
-  if(!scanline_ss_.eof()) {
-    scanline_ss_ >> token;
-    next_value = Utils::StringToLONG(token); 
-  }
+  StringView token = tokenizer_.Next();
+  Utils::Parsed<LONG> parsed = Utils::ParseLONG(token);
+  this->CheckParse(token, parsed.error);
+  next_value = parsed.value;
 
 #ifdef EBUGS
   Utils::logStream << TAG << "leave NextLONG '" << next_value << "'" << std::endl;
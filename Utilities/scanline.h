@@ -22,6 +22,8 @@
 #include <sys/resource.h>
 
 #include "../Utilities/utils.h"
+#include "../Utilities/stringview.h"
+#include "../Utilities/tokenizer.h"
 // #include "../Utilities/Scanner.h"
 
 #define NDEBUG
@@ -41,14 +43,17 @@ public:
 //  static stringstream zorkss;
 //  static ostringstream zorkoss;
 
- std::stringstream scanline_ss_;
-
 /****************************************************************
  * Constructors and destructors for the class. 
 **/
   ScanLine();
   virtual ~ScanLine();
 
+/****************************************************************
+ * Accessors and mutators.
+**/
+  Utils::ParseError GetParseError() const;
+
 /****************************************************************
  * General functions.
 **/
@@ -62,7 +67,18 @@ public:
   std::string NextLine();
 
 private:
+/****************************************************************
+ * Our own copy of the line, and the 'Tokenizer' that finds the
+ * tokens in it.
+**/
+  std::string line_;
+  Tokenizer tokenizer_;
+  Utils::ParseError parse_error_;
+
+  ScanLine(const ScanLine& that);
+  ScanLine& operator=(const ScanLine& that);
 
+  void CheckParse(StringView token, Utils::ParseError error);
 };
 
 #endif // SCANLINE_H
@@ -1,220 +1,445 @@
 #include "scanner.h"
 
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/****************************************************************
+ * The 'Scanner' maps the whole file into memory when it is
+ * opened and then scans the mapped text in place, so reading a
+ * file costs no copying and no 'getline'. 'NextView' and
+ * 'NextLineView' return pointers into the mapping, good until
+ * the 'Scanner' is closed; 'Next' and 'NextLine' copy the view
+ * into a 'string' for callers that want to keep it.
+ *
+ * A file that can't be mapped, such as a pipe, standard input,
+ * or an empty file, is read by a thread of its own into two
+ * blocks in turn. The scanner scans one block while the thread
+ * reads into the other, so a slow writer at the other end of a
+ * pipe holds up the scanner only when it has scanned everything
+ * that has been written. Here a view is good only until the next
+ * call, since the block it points into is then handed back to
+ * the reader.
+ *
+ * A token is anything other than whitespace, and whitespace is
+ * blank, tab, carriage return, newline, vertical tab, and form
+ * feed. A line ends at a newline or at a carriage return and a
+ * newline. The searches for these are the ones in 'Tokenizer'.
+**/
+
 /****************************************************************
  * Constructor.
 **/
 Scanner::Scanner() {
-  scanline_.OpenString("");
-
-  std::string the_next = scanline_.Next();
+  file_descriptor_ = -1;
+  is_owner_ = false;
+  mapping_ = NULL;
+  mapping_length_ = 0;
+  next_ = NULL;
+  end_ = NULL;
+  parse_error_ = Utils::kParseOK;
+  wake_pipe_[0] = -1;
+  wake_pipe_[1] = -1;
 }
 
 /****************************************************************
  * Destructor.
 **/
 Scanner::~Scanner() {
+  this->Release();
+  if (is_owner_ && (file_descriptor_ >= 0)) {
+    close(file_descriptor_);
+  }
 }
 
 /****************************************************************
  * Accessors and mutators.
 **/
+/****************************************************************
+ * Accessor for 'parse_error_'.
+ *
+ * Returns:
+ *   the error from the last 'NextDouble', 'NextInt', or 'NextLONG'
+**/
+Utils::ParseError Scanner::GetParseError() const {
+  return parse_error_;
+}
 
 /****************************************************************
  * General functions.
 **/
 /****************************************************************
- * Function to close the stream.
+ * Function to keep the error from parsing a token, and log it if
+ * there is one.
+**/
+void Scanner::CheckParse(StringView token, Utils::ParseError error) {
+  parse_error_ = error;
+  if ((Utils::kParseOK != error) && (Utils::kParseEmpty != error)) {
+    Utils::log_stream << kTag << "ERROR: token '" << token << "' "
+                      << Utils::ParseErrorName(error) << "\n";
+  }
+}
+
+/****************************************************************
+ * Function to close the file. Views that were returned are no
+ * longer good after this.
 **/
 void Scanner::Close() {
-  Utils::FileClose(local_stream_);
+  this->Release();
+  if (is_owner_) {
+    Utils::FileClose(file_descriptor_);
+  }
+  file_descriptor_ = -1;
+  is_owner_ = false;
 }
 
 /****************************************************************
  * Function for testing for more data in the file.
  *
+ * This skips the whitespace, including any blank lines, up to
+ * the next token, so that 'NextLine' afterwards returns the line
+ * starting at that token.
+ *
  * Returns:
- *   true if there is a 'next' of anything in the file. 
+ *   true if there is a 'next' of anything in the file.
 **/
 bool Scanner::HasNext() {
-  bool return_value = true;
-
-//  std::cout << TAG << "enter HasNext" << std::endl;
-
-  if (scanline_.HasNext()) {
-//    std::cout << TAG << "scanLine HasNext true" << std::endl;
-//    std::cout << TAG << "leave HasNext" << std::endl;
-    return true;
-  } else {
-    bool got_answer = false;
-    while (!got_answer) {
-//      std::cout << TAG << "scanLine HasNext false" << std::endl;
-      std::string next_line = this->NextLine();
-//      std::cout << TAG << "next line is " << NextLine << std::endl;
-      next_line = Utils::TrimBlanks(next_line);
-      if (0 == next_line.length()) {
-//        std::cout << TAG << "next line exists and is blank " << NextLine << std::endl;
-//        std::cout << TAG << "leave HasNext" << std::endl;
-//        return false;
-        if (local_stream_.eof()) return false;
-      } else {
-//        std::cout << TAG << "next line exists and is not blank " << NextLine << std::endl;
-        scanline_.OpenString(next_line);
-//        std::cout << TAG << "leave HasNext" << std::endl;
-        got_answer = true;
-        return true;
-      }
-    } // while (!got_answer)
-
+  while (true) {
+    next_ = Tokenizer::SkipWhitespace(next_, end_);
+    const char* start = next_;
+    if ((next_ < end_) || !this->Refill(start)) {
+      return next_ < end_;
+    }
   }
-
-//  std::cout << TAG << "leave HasNext" << std::endl;
-
-  return return_value;
 } // bool Scanner::HasNext()
 
 /****************************************************************
  * Function for returning a next token as a string.
  *
- * The definition of a 'token' is anything other than whitespace.
- * In this implementation, whitespace includes newline, carriage
- * return, and tab.
- *
- * We have two booleans to keep track of three states:
- *   have not yet found NWS (token beginning)
- *   have not yet found WS after finding NWS (token end)
- *
- * We read a character.
- * If there is no next character to be read
- *    Then we throw an error
- * While we are not at end of file:
- *    Test the char for NWS
- *    If NWS
- *       Set the bool that we have found NWS
- *       If we have found WS after NWS, 
- *          put back the NWS--it's the start of the next token
- *          break
- *       Else append the NWS to the token
- *    Else (i.e., if WS)
- *       If we have ever found NWS
- *          Set the bool that we have found WS after NWS
- *    Read the next character.
- *
  * Returns:
  *   the 'string' version of the next token.
 **/
 std::string Scanner::Next() {
-
-  std::string return_value = scanline_.Next();
-
-  return return_value;
+  return this->NextView().ToString();
 } // string Scanner::Next()
 
-/****************************************************************
- * Function for returning a next character.
- *
- * Returns:
- *   the next character in the file
-char Scanner::nextChar()
-{
-  char c = this->localStream.get();
-  return c;
-} // char Scanner::nextChar()
-**/
-
 /****************************************************************
  * Function for returning a next 'double'.
  *
- * This function does not trap errors. Errors converting from
- * 'string' to 'double' simply cause crashing.
+ * A token that is not a number, or no token, gives zero, and
+ * 'GetParseError' says which.
  *
  * Returns:
  *   the next token in the file, parsed as a 'double'
 **/
 double Scanner::NextDouble() {
-  double return_value;
-
-  std::string next_token = this->Next();
-  return_value = atof(next_token.c_str());
-
-  return return_value;
+  StringView token = this->NextView();
+  Utils::Parsed<double> parsed = Utils::ParseDouble(token);
+  this->CheckParse(token, parsed.error);
+  return parsed.value;
 } // double Scanner::NextDouble()
 
 /****************************************************************
  * Function for returning the next 'int' value.
  *
- * This function does not really trap errors. Errors in converting
- * from 'string' to 'int' simply cause crashing.
+ * A token that is not an 'int', or no token, gives zero, and
+ * 'GetParseError' says which.
  *
  * Returns:
  *   the next token in the file, parsed as an 'int'
 **/
 int Scanner::NextInt() {
-  int return_value;
-  std::string next_token;
-
-  return_value = 0;
-  next_token = this->Next();
-
-  return_value = Utils::StringToInteger(next_token);
-
-  return return_value;
+  StringView token = this->NextView();
+  Utils::Parsed<int> parsed = Utils::ParseInt(token);
+  this->CheckParse(token, parsed.error);
+  return parsed.value;
 } // int Scanner::NextInt()
 
 /****************************************************************
  * Function for returning the rest of the line as a string.
  *
- * This is just a wrapper for the 'getline' function.
- * Note that this does not trim whitespace at the beginning
- * or at the end.
- *
  * Returns:
  *   the 'string' version of the rest of the line
 **/
 std::string Scanner::NextLine() {
-  std::string return_value;
-
-//  std::cout << TAG << "enter NextLine" << std::endl;
+  return this->NextLineView().ToString();
+} // string Scanner::NextLine()
 
-  if (scanline_.HasNext())
-  {
-    return_value = scanline_.NextLine();
-//    std::cout << TAG << "scanLine hasNext " << return_value << std::endl;
-  }
-  else
-  {
-    getline(local_stream_, return_value);
-//    std::cout << TAG << "scanLine needed new line " << return_value << std::endl;
+/****************************************************************
+ * Function for returning the rest of the line as a view into
+ * the file. The line does not include the newline, nor blanks
+ * or a carriage return at the end.
+ *
+ * Returns:
+ *   the rest of the line, empty at the end of the file
+**/
+StringView Scanner::NextLineView() {
+  const char* start = next_;
+  const char* stop = end_;
+  while (true) {
+    stop = Tokenizer::FindNewline(next_, end_);
+    if ((stop < end_) || !this->Refill(start)) {
+      break;
+    }
   }
+  next_ = (stop < end_) ? stop + 1 : end_;
 
-//  std::cout << TAG << "leave NextLine" << std::endl;
-  return return_value;
-} // string Scanner::NextLine()
+  while ((stop > start) && ((' ' == stop[-1]) || ('\r' == stop[-1]))) {
+    --stop;
+  }
+  return StringView(start, stop - start);
+} // StringView Scanner::NextLineView()
 
 /****************************************************************
  * Function for returning the next 'LONG' value.
  *
- * This function does not really trap errors. Errors in converting
- * from 'string' to 'LONG' simply cause crashing.
+ * A token that is not a 'LONG', or no token, gives zero, and
+ * 'GetParseError' says which.
  *
  * Returns:
- *   the next token in the file, parsed as an 'LONG'
+ *   the next token in the file, parsed as a 'LONG'
 **/
 LONG Scanner::NextLONG() {
-  LONG return_value;
-  std::string next_token;
+  StringView token = this->NextView();
+  Utils::Parsed<LONG> parsed = Utils::ParseLONG(token);
+  this->CheckParse(token, parsed.error);
+  return parsed.value;
+} // LONG Scanner::NextLONG()
 
-  return_value = 0;
-  next_token = this->Next();
+/****************************************************************
+ * Function for returning a next token as a view into the file.
+ *
+ * The definition of a 'token' is anything other than whitespace.
+ * Tokens are not limited to one line; if the rest of the line is
+ * whitespace the token comes from the next line that has one.
+ *
+ * Returns:
+ *   the next token, empty at the end of the file
+**/
+StringView Scanner::NextView() {
+  if (!this->HasNext()) {
+    return StringView();
+  }
+  const char* start = next_;
+  while (true) {
+    next_ = Tokenizer::FindWhitespace(next_, end_);
+    if ((next_ < end_) || !this->Refill(start)) {
+      break;
+    }
+  }
+  return StringView(start, next_ - start);
+} // StringView Scanner::NextView()
 
-  return_value = Utils::StringToLONG(next_token);
+/****************************************************************
+ * Function to open a file that is already open, such as standard
+ * input, as a 'Scanner'. The 'Scanner' does not close it.
+ *
+ * A regular file is mapped. Anything else is read ahead by a
+ * thread of its own.
+**/
+void Scanner::OpenDescriptor(int file_descriptor) {
+  this->Release();
+  if (is_owner_ && (file_descriptor_ >= 0)) {
+    close(file_descriptor_);
+  }
+  file_descriptor_ = file_descriptor;
+  is_owner_ = false;
+
+  struct stat file_status;
+  if ((0 == fstat(file_descriptor_, &file_status)) &&
+      S_ISREG(file_status.st_mode) && (file_status.st_size > 0)) {
+    void* mapping = mmap(NULL, file_status.st_size, PROT_READ, MAP_PRIVATE,
+                         file_descriptor_, 0);
+    if (MAP_FAILED != mapping) {
+      madvise(mapping, file_status.st_size, MADV_SEQUENTIAL);
+      mapping_ = mapping;
+      mapping_length_ = file_status.st_size;
+      next_ = static_cast<const char*>(mapping_);
+      end_ = next_ + mapping_length_;
+      return;
+    }
+  }
 
-  return return_value;
-} // LONG Scanner::NextLONG()
+  if (0 != pipe(wake_pipe_)) {
+    wake_pipe_[0] = -1;
+    wake_pipe_[1] = -1;
+  }
+  for (int block = 0; block < 2; ++block) {
+    blocks_[block].resize(kCarrySpace + kBufferSize);
+    block_lengths_[block] = 0;
+    is_block_full_[block] = false;
+  }
+  next_block_ = 0;
+  scanning_block_ = -1;
+  is_end_of_input_ = false;
+  is_stopping_ = false;
+  reader_ = std::thread(&Scanner::ReadAhead, this);
+}
 
 /****************************************************************
  * Function to open a file as a 'Scanner'.
 **/
 void Scanner::OpenFile(std::string filename) {
-  Utils::FileOpen(local_stream_, filename);
+  int file_descriptor = -1;
+  Utils::FileOpen(file_descriptor, filename);
+  this->OpenDescriptor(file_descriptor);
+  is_owner_ = true;
 }
 
+/****************************************************************
+ * Function run by the read-ahead thread.
+ *
+ * We fill the blocks in turn, waiting for the scanner to be done
+ * with a block before filling it again. Each block gets what one
+ * 'read' returns, so that whatever a pipe has is passed on at
+ * once rather than held until the block is full. The 'poll' on
+ * the wake pipe lets 'Release' stop us while we wait for input.
+**/
+void Scanner::ReadAhead() {
+  int block = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(block_mutex_);
+      while (!is_stopping_ && is_block_full_[block]) {
+        block_changed_.wait(lock);
+      }
+      if (is_stopping_) {
+        return;
+      }
+    }
+
+    ssize_t how_many = -1;
+    struct pollfd waiting[2];
+    waiting[0].fd = file_descriptor_;
+    waiting[0].events = POLLIN;
+    waiting[1].fd = wake_pipe_[0];
+    waiting[1].events = POLLIN;
+    while (true) {
+      waiting[0].revents = 0;
+      waiting[1].revents = 0;
+      int ready = poll(waiting, (wake_pipe_[0] >= 0) ? 2 : 1, -1);
+      if ((ready < 0) && (EINTR == errno)) {
+        continue;
+      }
+      if ((ready < 0) || (0 != waiting[1].revents)) {
+        break;
+      }
+      how_many = read(file_descriptor_, &blocks_[block][kCarrySpace],
+                      kBufferSize);
+      if ((how_many >= 0) || (EINTR != errno)) {
+        break;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(block_mutex_);
+    if (how_many <= 0) {
+      is_end_of_input_ = true;
+      block_changed_.notify_all();
+      return;
+    }
+    block_lengths_[block] = static_cast<int>(how_many);
+    is_block_full_[block] = true;
+    block_changed_.notify_all();
+    block = 1 - block;
+  }
+}
+
+/****************************************************************
+ * Function to get the next block from the read-ahead thread.
+ *
+ * What is left of the text from 'start' on is the beginning of a
+ * token or a line that goes on in the next block, so it is put
+ * in front of the next block, and 'start' is moved to where it
+ * now is. 'next_' goes to the first new character.
+ *
+ * Returns:
+ *   false if there is no more input, leaving everything as it was
+**/
+bool Scanner::Refill(const char*& start) {
+  if (!reader_.joinable()) {
+    return false;
+  }
+
+  int block = next_block_;
+  {
+    std::unique_lock<std::mutex> lock(block_mutex_);
+    while (!is_block_full_[block] && !is_end_of_input_) {
+      block_changed_.wait(lock);
+    }
+    if (!is_block_full_[block]) {
+      return false;
+    }
+  }
+
+  size_t tail_length = end_ - start;
+  char* data = &blocks_[block][kCarrySpace];
+  int length = block_lengths_[block];
+  char* text = data - tail_length;
+  bool is_carried = (tail_length > static_cast<size_t>(kCarrySpace));
+  if (is_carried) {
+    std::string carry(start, tail_length);
+    carry.append(data, length);
+    carry_.swap(carry);
+    text = &carry_[0];
+  } else if (tail_length > 0) {
+    memcpy(text, start, tail_length);
+  }
+
+  // The block we were scanning, and this one too if it was copied,
+  // go back to the reader.
+  {
+    std::lock_guard<std::mutex> lock(block_mutex_);
+    if (scanning_block_ >= 0) {
+      is_block_full_[scanning_block_] = false;
+    }
+    if (is_carried) {
+      is_block_full_[block] = false;
+    }
+    block_changed_.notify_all();
+  }
+  scanning_block_ = is_carried ? -1 : block;
+  next_block_ = 1 - block;
+
+  start = text;
+  next_ = text + tail_length;
+  end_ = next_ + length;
+  return true;
+}
+
+/****************************************************************
+ * Function to let go of the text, stopping the read-ahead or
+ * unmapping the file.
+**/
+void Scanner::Release() {
+  if (reader_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(block_mutex_);
+      is_stopping_ = true;
+      block_changed_.notify_all();
+    }
+    if (wake_pipe_[1] >= 0) {
+      char wake = 0;
+      ssize_t written = write(wake_pipe_[1], &wake, 1);
+      (void) written;
+    }
+    reader_.join();
+  }
+  for (int end = 0; end < 2; ++end) {
+    if (wake_pipe_[end] >= 0) {
+      close(wake_pipe_[end]);
+    }
+    wake_pipe_[end] = -1;
+  }
+  carry_.clear();
+
+  if (NULL != mapping_) {
+    munmap(mapping_, mapping_length_);
+  }
+  mapping_ = NULL;
+  mapping_length_ = 0;
+  next_ = NULL;
+  end_ = NULL;
+}
@@ -10,12 +10,17 @@
 
 #include <iostream>
 #include <fstream>
+#include <condition_variable>
 #include <cstdlib>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "utils.h"
 #include "scanline.h"
+#include "stringview.h"
+#include "tokenizer.h"
 
 #define NDEBUG
 #include <cassert>
@@ -24,16 +29,19 @@ typedef int64_t LONG;
 
 class Scanner {
 public:
+  static const int kBufferSize = 1 << 20;
+  static const int kCarrySpace = 4096;
+
 /****************************************************************
- * Constructors and destructors for the class. 
+ * Constructors and destructors for the class.
 **/
   Scanner();
   virtual ~Scanner();
 
 /****************************************************************
- * Variables.
+ * Accessors and mutators.
 **/
-  std::ifstream local_stream_;
+  Utils::ParseError GetParseError() const;
 
 /****************************************************************
  * General functions.
@@ -43,6 +51,9 @@ public:
   double NextDouble();
   std::string Next();
   std::string NextLine();
+  StringView NextLineView();
+  StringView NextView();
+  void OpenDescriptor(int file_descriptor);
   void OpenFile(std::string filename);
   int NextInt();
   LONG NextLONG();
@@ -50,7 +61,48 @@ public:
 private:
   const std::string kTag = "SCANNER: ";
 
-  ScanLine scanline_;
+/****************************************************************
+ * The text being scanned runs from 'next_', where the scanning
+ * has got to, to 'end_'. It is either the whole file, mapped,
+ * or for a file that can't be mapped such as a pipe, the block
+ * that the read-ahead thread filled last.
+**/
+  int file_descriptor_;
+  bool is_owner_;
+  void* mapping_;
+  size_t mapping_length_;
+  const char* next_;
+  const char* end_;
+  Utils::ParseError parse_error_;
+
+/****************************************************************
+ * The read-ahead. The reader thread fills the two blocks in turn
+ * while the scanner scans the other one. 'is_block_full_' says
+ * a block belongs to the scanner until it is done with it.
+ * Every block has 'kCarrySpace' free in front of the data, so a
+ * token or a line that runs across two blocks can be copied in
+ * front of the second one; a longer one goes into 'carry_'.
+**/
+  std::vector<char> blocks_[2];
+  int block_lengths_[2];
+  bool is_block_full_[2];
+  int next_block_;
+  int scanning_block_;
+  bool is_end_of_input_;
+  bool is_stopping_;
+  int wake_pipe_[2];
+  std::string carry_;
+  std::thread reader_;
+  std::mutex block_mutex_;
+  std::condition_variable block_changed_;
+
+  Scanner(const Scanner& that);
+  Scanner& operator=(const Scanner& that);
+
+  void CheckParse(StringView token, Utils::ParseError error);
+  void ReadAhead();
+  bool Refill(const char*& start);
+  void Release();
 };
 
 #endif // SCANNER_H_
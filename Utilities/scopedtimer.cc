@@ -0,0 +1,500 @@
+#include "scopedtimer.h"
+
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+/****************************************************************
+ * Class 'ScopedTimer' for timing the phases of a program.
+ *
+ * The time is read from the monotonic clock, in nanoseconds, or
+ * on an x86 with an invariant time stamp counter from the TSC,
+ * which is cheaper to read and is turned into nanoseconds for the
+ * report by timing it against the monotonic clock once.
+ *
+ * Entering a phase looks for it among the children of the phase
+ * the thread is in, by the pointer to its name and only then by
+ * comparing the names, so a timer costs two clock reads and a
+ * short search. The tree of a thread belongs to that thread, and
+ * the report should be written when the other threads are done
+ * timing. A phase still running when it is written, as when the
+ * program calls 'exit' from inside it, is shown with the time it
+ * has run so far.
+ *
+ * Counting reads the 'PerfCounters' of the thread when a phase is
+ * entered and left, which is a system call each time, so with
+ * counting on a timer costs a few microseconds rather than tens
+ * of nanoseconds, and short phases are mostly that cost. The
+ * allocation counts are only two reads of a 'thread_local'.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+**/
+
+bool ScopedTimer::is_counting_ = false;
+bool ScopedTimer::is_enabled_ = false;
+std::string ScopedTimer::counting_error_ = "";
+ScopedTimer::Clock ScopedTimer::clock_ = ScopedTimer::kClockMonotonic;
+double ScopedTimer::nanoseconds_per_tick_ = 1.0;
+std::mutex ScopedTimer::threads_mutex_;
+std::vector<std::unique_ptr<ScopedTimer::ThreadTimes> >
+    ScopedTimer::threads_;
+thread_local ScopedTimer::ThreadTimes* ScopedTimer::this_thread_ = NULL;
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Accessor for 'clock_'.
+**/
+ScopedTimer::Clock ScopedTimer::GetClock() {
+  return clock_;
+}
+
+/****************************************************************
+ * Mutator for 'clock_'. This must be called before any timing is
+ * done. Choosing the TSC times it against the monotonic clock for
+ * ten milliseconds.
+ *
+ * Returns:
+ *   false if the TSC was chosen and this machine has no invariant
+ *   TSC, leaving the clock as it was
+**/
+bool ScopedTimer::SetClock(Clock clock) {
+  if (kClockMonotonic == clock) {
+    clock_ = kClockMonotonic;
+    nanoseconds_per_tick_ = 1.0;
+    return true;
+  }
+
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if ((0 == __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) ||
+      (0 == (edx & (1 << 8)))) {
+    return false;
+  }
+
+  clock_ = kClockMonotonic;
+  LONG nanoseconds_before = Now();
+  LONG ticks_before = static_cast<LONG>(__rdtsc());
+  LONG nanoseconds_after = nanoseconds_before;
+  while (nanoseconds_after - nanoseconds_before < 10000000) {
+    nanoseconds_after = Now();
+  }
+  LONG ticks_after = static_cast<LONG>(__rdtsc());
+  if (ticks_after <= ticks_before) {
+    return false;
+  }
+  nanoseconds_per_tick_ =
+      static_cast<double>(nanoseconds_after - nanoseconds_before) /
+      static_cast<double>(ticks_after - ticks_before);
+  clock_ = kClockTSC;
+  return true;
+#else
+  return false;
+#endif
+}
+
+/****************************************************************
+ * Accessor for 'counting_error_'.
+ *
+ * Returns:
+ *   why a counter could not be opened on the first thread, or ""
+**/
+std::string ScopedTimer::GetCountingError() {
+  return counting_error_;
+}
+
+/****************************************************************
+ * Accessor for 'is_counting_'.
+**/
+bool ScopedTimer::IsCounting() {
+  return is_counting_;
+}
+
+/****************************************************************
+ * Mutator for 'is_counting_'. Like 'SetEnabled' this should be
+ * called before other threads are started. Turning counting on
+ * opens the counters of the calling thread, and of every thread
+ * after it the first time it times anything.
+ *
+ * Returns:
+ *   false if counting was asked for and no counter at all could
+ *   be opened, leaving counting off
+**/
+bool ScopedTimer::SetCounting(bool value) {
+  if (!value) {
+    is_counting_ = false;
+    return true;
+  }
+  is_counting_ = true;
+  ThreadTimes* times = GetThreadTimes();
+  if (NULL == times->counters) {
+    times->counters.reset(new PerfCounters());
+    times->counters->Open();
+  }
+  counting_error_ = times->counters->GetError();
+  if (!times->counters->IsOpen()) {
+    times->counters.reset();
+    is_counting_ = false;
+    return false;
+  }
+  return true;
+}
+
+/****************************************************************
+ * Accessor for 'is_enabled_'.
+**/
+bool ScopedTimer::IsEnabled() {
+  return is_enabled_;
+}
+
+/****************************************************************
+ * Mutator for 'is_enabled_'. This should be set before other
+ * threads are started.
+**/
+void ScopedTimer::SetEnabled(bool value) {
+  is_enabled_ = value;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function 'FindChild'.
+ *
+ * Returns:
+ *   the phase 'name' below the current phase of 'times', added
+ *   if it is not there yet
+**/
+int ScopedTimer::FindChild(ThreadTimes* times, const char* name) {
+  int first = (times->current < 0) ? -1
+            : times->phases[times->current].first_child;
+  int last = -1;
+  if (times->current < 0) {
+    // The top phases are the ones with no parent.
+    for (int sub = 0; sub < static_cast<int>(times->phases.size()); ++sub) {
+      if (times->phases[sub].parent < 0) {
+        first = sub;
+        break;
+      }
+    }
+  }
+  for (int sub = first; sub >= 0; sub = times->phases[sub].next_sibling) {
+    const char* that_name = times->phases[sub].name;
+    if ((that_name == name) || (0 == strcmp(that_name, name))) {
+      return sub;
+    }
+    last = sub;
+  }
+
+  Phase phase;
+  phase.name = name;
+  phase.parent = times->current;
+  phase.first_child = -1;
+  phase.next_sibling = -1;
+  phase.calls = 0;
+  phase.ticks = 0;
+  phase.started = 0;
+  phase.is_running = false;
+  for (int counter = 0; counter < PerfCounters::kHowMany; ++counter) {
+    phase.counts[counter] = 0;
+    phase.started_counts[counter] = 0;
+  }
+  AllocationCounter::Counts no_counts = { 0, 0, 0 };
+  phase.allocations = no_counts;
+  phase.started_allocations = no_counts;
+  int sub = static_cast<int>(times->phases.size());
+  times->phases.push_back(phase);
+  if (last >= 0) {
+    times->phases[last].next_sibling = sub;
+  } else if (times->current >= 0) {
+    times->phases[times->current].first_child = sub;
+  }
+  return sub;
+}
+
+/****************************************************************
+ * Function 'GetThreadTimes'.
+ *
+ * The tree is made with room for 'kPhasesReserved' phases, so
+ * that entering a new phase doesn't allocate in the middle of
+ * what is being counted.
+ *
+ * Returns:
+ *   the tree of this thread, made the first time it is asked for
+**/
+ScopedTimer::ThreadTimes* ScopedTimer::GetThreadTimes() {
+  if (NULL == this_thread_) {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    std::unique_ptr<ThreadTimes> times(new ThreadTimes());
+    times->thread_number = static_cast<int>(threads_.size()) + 1;
+    times->current = -1;
+    times->phases.reserve(kPhasesReserved);
+    if (is_counting_) {
+      times->counters.reset(new PerfCounters());
+      if (!times->counters->Open()) {
+        times->counters.reset();
+      }
+    }
+    this_thread_ = times.get();
+    threads_.push_back(std::move(times));
+  }
+  return this_thread_;
+}
+
+/****************************************************************
+ * Function 'TicksToNanoseconds'.
+ *
+ * Returns:
+ *   the time of 'ticks' of the clock in use, in nanoseconds
+**/
+double ScopedTimer::TicksToNanoseconds(LONG ticks) {
+  return nanoseconds_per_tick_ * static_cast<double>(ticks);
+}
+
+/****************************************************************
+ * Function 'WriteAllocations', to write the allocations of one
+ * phase and then of its children, as 'WritePhase' does the times.
+ *
+ * Parameters:
+ *   out_stream - where to write
+ *   times - the tree of the thread
+ *   phase - the phase to write
+ *   depth - how far down the tree it is
+ *   now_counts - the counts now, for phases that are running, or
+ *                NULL if they can't be read from this thread
+**/
+void ScopedTimer::WriteAllocations(
+    std::ostream& out_stream, const ThreadTimes& times, int phase,
+    int depth, const AllocationCounter::Counts* now_counts) {
+  const Phase& this_phase = times.phases[phase];
+  AllocationCounter::Counts counts = this_phase.allocations;
+  if (this_phase.is_running && (NULL != now_counts)) {
+    const AllocationCounter::Counts& started =
+        this_phase.started_allocations;
+    counts.allocations += now_counts->allocations - started.allocations;
+    counts.frees += now_counts->frees - started.frees;
+    counts.bytes += now_counts->bytes - started.bytes;
+  }
+
+  std::string name = std::string(2 * depth, ' ') + this_phase.name;
+  if (this_phase.is_running) {
+    name += " *";
+  }
+  name.resize(32, ' ');
+  char line[160];
+  snprintf(line, sizeof(line), "%s %15lld %15lld %15lld", name.c_str(),
+           static_cast<long long>(counts.allocations),
+           static_cast<long long>(counts.frees),
+           static_cast<long long>(counts.bytes));
+  out_stream << line << std::endl;
+
+  for (int child = this_phase.first_child; child >= 0;
+       child = times.phases[child].next_sibling) {
+    WriteAllocations(out_stream, times, child, depth + 1, now_counts);
+  }
+}
+
+/****************************************************************
+ * Function 'WriteCounts', to write the counts of one phase and
+ * then of its children, indented below it, as 'WritePhase' does
+ * the times. IPC is instructions per cycle, and a counter the
+ * thread doesn't have is 'n/a'.
+ *
+ * Parameters:
+ *   out_stream - where to write
+ *   times - the tree of the thread
+ *   phase - the phase to write
+ *   depth - how far down the tree it is
+ *   now_counts - the counts now, for phases that are running, or
+ *                NULL if they can't be read from this thread
+**/
+void ScopedTimer::WriteCounts(std::ostream& out_stream,
+                              const ThreadTimes& times, int phase, int depth,
+                              const LONG* now_counts) {
+  const Phase& this_phase = times.phases[phase];
+  LONG counts[PerfCounters::kHowMany];
+  for (int counter = 0; counter < PerfCounters::kHowMany; ++counter) {
+    counts[counter] = this_phase.counts[counter];
+    if (this_phase.is_running && (NULL != now_counts)) {
+      counts[counter] += now_counts[counter] -
+                         this_phase.started_counts[counter];
+    }
+  }
+
+  std::string name = std::string(2 * depth, ' ') + this_phase.name;
+  if (this_phase.is_running) {
+    name += " *";
+  }
+  name.resize(32, ' ');
+  std::string line = name;
+  static const int kWidths[PerfCounters::kHowMany] = { 15, 15, 15, 15, 12 };
+  char field[40];
+  for (int counter = 0; counter < PerfCounters::kHowMany; ++counter) {
+    if (times.counters->IsAvailable(counter)) {
+      snprintf(field, sizeof(field), " %*lld", kWidths[counter],
+               static_cast<long long>(counts[counter]));
+    } else {
+      snprintf(field, sizeof(field), " %*s", kWidths[counter], "n/a");
+    }
+    line += field;
+    if (PerfCounters::kCycles == counter) {
+      if (times.counters->IsAvailable(PerfCounters::kInstructions) &&
+          times.counters->IsAvailable(PerfCounters::kCycles) &&
+          (counts[PerfCounters::kCycles] > 0)) {
+        snprintf(field, sizeof(field), " %6.2f",
+                 static_cast<double>(counts[PerfCounters::kInstructions]) /
+                 static_cast<double>(counts[PerfCounters::kCycles]));
+      } else {
+        snprintf(field, sizeof(field), " %6s", "n/a");
+      }
+      line += field;
+    }
+  }
+  out_stream << line << std::endl;
+
+  for (int child = this_phase.first_child; child >= 0;
+       child = times.phases[child].next_sibling) {
+    WriteCounts(out_stream, times, child, depth + 1, now_counts);
+  }
+}
+
+/****************************************************************
+ * Function 'WritePhase', to write one line of the report and then
+ * the lines of the children of the phase, indented below it.
+ *
+ * Parameters:
+ *   out_stream - where to write
+ *   times - the tree of the thread
+ *   phase - the phase to write
+ *   depth - how far down the tree it is
+ *   now - the time now, for phases that are running
+ *   total - the time of the whole thread, in nanoseconds
+**/
+void ScopedTimer::WritePhase(std::ostream& out_stream,
+                             const ThreadTimes& times, int phase, int depth,
+                             LONG now, double total) {
+  const Phase& this_phase = times.phases[phase];
+  LONG ticks = this_phase.ticks;
+  if (this_phase.is_running) {
+    ticks += now - this_phase.started;
+  }
+  double nanoseconds = TicksToNanoseconds(ticks);
+
+  double children = 0.0;
+  for (int child = this_phase.first_child; child >= 0;
+       child = times.phases[child].next_sibling) {
+    LONG child_ticks = times.phases[child].ticks;
+    if (times.phases[child].is_running) {
+      child_ticks += now - times.phases[child].started;
+    }
+    children += TicksToNanoseconds(child_ticks);
+  }
+  double self = (nanoseconds > children) ? nanoseconds - children : 0.0;
+
+  std::string name = std::string(2 * depth, ' ') + this_phase.name;
+  if (this_phase.is_running) {
+    name += " *";
+  }
+  name.resize(32, ' ');
+  char line[160];
+  snprintf(line, sizeof(line), "%s %10lld %15.3f %8.2f %15.3f", name.c_str(),
+           static_cast<long long>(this_phase.calls), nanoseconds / 1.0e6,
+           (total > 0.0) ? 100.0 * nanoseconds / total : 0.0, self / 1.0e6);
+  out_stream << line << std::endl;
+
+  for (int child = this_phase.first_child; child >= 0;
+       child = times.phases[child].next_sibling) {
+    WritePhase(out_stream, times, child, depth + 1, now, total);
+  }
+}
+
+/****************************************************************
+ * Function 'WriteReport', to write the tree of every thread that
+ * has timed anything. The percent is of the time of the thread,
+ * which is the time of its top phases, and 'SELF' is the time in
+ * a phase that is not in any of its children.
+**/
+void ScopedTimer::WriteReport(std::ostream& out_stream) {
+  LONG now = Now();
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+
+  if (kClockTSC == clock_) {
+    char line[80];
+    snprintf(line, sizeof(line), "TIMING: TSC CLOCK AT %.3f GHZ",
+             1.0 / nanoseconds_per_tick_);
+    out_stream << line << std::endl;
+  } else {
+    out_stream << "TIMING: MONOTONIC CLOCK" << std::endl;
+  }
+  if (is_counting_ && (counting_error_ != "")) {
+    out_stream << "TIMING: NOT COUNTED: " << counting_error_ << std::endl;
+  }
+
+  bool is_any_running = false;
+  for (auto iter = threads_.begin(); iter != threads_.end(); ++iter) {
+    const ThreadTimes& times = **iter;
+    double total = 0.0;
+    for (auto phase = times.phases.begin(); phase != times.phases.end();
+         ++phase) {
+      if (phase->parent < 0) {
+        total += TicksToNanoseconds(phase->is_running
+                                    ? phase->ticks + now - phase->started
+                                    : phase->ticks);
+      }
+      is_any_running = is_any_running || phase->is_running;
+    }
+
+    out_stream << std::endl;
+    out_stream << "THREAD " << times.thread_number << std::endl;
+    out_stream << "PHASE                                 CALLS"
+               << "    MILLISECONDS  PERCENT         SELF MS" << std::endl;
+    for (int phase = 0; phase < static_cast<int>(times.phases.size());
+         ++phase) {
+      if (times.phases[phase].parent < 0) {
+        WritePhase(out_stream, times, phase, 0, now, total);
+      }
+    }
+
+    if (NULL != times.counters) {
+      LONG now_counts[PerfCounters::kHowMany];
+      bool is_this_thread = (&times == this_thread_) &&
+                            times.counters->Read(now_counts);
+      out_stream << std::endl;
+      out_stream << "PHASE                              INSTRUCTIONS"
+                 << "          CYCLES    IPC   BRANCH MISSES    CACHE MISSES"
+                 << "  PAGE FAULTS" << std::endl;
+      for (int phase = 0; phase < static_cast<int>(times.phases.size());
+           ++phase) {
+        if (times.phases[phase].parent < 0) {
+          WriteCounts(out_stream, times, phase, 0,
+                      is_this_thread ? now_counts : NULL);
+        }
+      }
+    }
+
+    if (AllocationCounter::IsEnabled()) {
+      AllocationCounter::Counts now_counts =
+          AllocationCounter::GetThreadCounts();
+      out_stream << std::endl;
+      out_stream << "PHASE                               ALLOCATIONS"
+                 << "           FREES           BYTES" << std::endl;
+      for (int phase = 0; phase < static_cast<int>(times.phases.size());
+           ++phase) {
+        if (times.phases[phase].parent < 0) {
+          WriteAllocations(out_stream, times, phase, 0,
+                           (&times == this_thread_) ? &now_counts : NULL);
+        }
+      }
+    }
+  }
+
+  if (is_any_running) {
+    out_stream << std::endl;
+    out_stream << "* still running when this was written" << std::endl;
+  }
+}
@@ -0,0 +1,199 @@
+/****************************************************************
+ * Header for the 'ScopedTimer' class.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+ * A 'ScopedTimer' times the block it is declared in, from its
+ * construction to its destruction. Timers declared inside the
+ * block of another timer are its children, so the times form a
+ * tree of phases and subphases. Every thread has its own tree,
+ * and a phase that is entered again adds to its count and time.
+ * With counting on, every phase also gets what the 'PerfCounters'
+ * of its thread counted while it ran, and with the 'AllocationCounter'
+ * on, the allocations its thread made.
+ *
+ * A timer costs two clock reads and a map lookup, which is more than
+ * an interpreted instruction, so time whole phases and not the work
+ * done for each instruction.
+**/
+
+#ifndef SCOPEDTIMER_H_
+#define SCOPEDTIMER_H_
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <time.h>
+
+#include "allocationcounter.h"
+#include "perfcounters.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+typedef int64_t LONG;
+
+class ScopedTimer {
+public:
+  enum Clock { kClockMonotonic, kClockTSC };
+  static const int kPhasesReserved = 64;
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+  explicit ScopedTimer(const char* name);
+  ~ScopedTimer();
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+  static Clock GetClock();
+  static bool SetClock(Clock clock);
+  static std::string GetCountingError();
+  static bool IsCounting();
+  static bool SetCounting(bool value);
+  static bool IsEnabled();
+  static void SetEnabled(bool value);
+
+/****************************************************************
+ * General functions.
+**/
+  static LONG Now();
+  static double TicksToNanoseconds(LONG ticks);
+  static void WriteReport(std::ostream& out_stream);
+
+private:
+/****************************************************************
+ * One phase in the tree of a thread. The children of a phase are
+ * a list through 'first_child' and 'next_sibling'; -1 ends it.
+ * 'started' is when the phase was entered if it is running now,
+ * and 'started_counts' and 'started_allocations' what the counts
+ * were then.
+**/
+  struct Phase {
+    const char* name;
+    int parent;
+    int first_child;
+    int next_sibling;
+    LONG calls;
+    LONG ticks;
+    LONG started;
+    bool is_running;
+    LONG counts[PerfCounters::kHowMany];
+    LONG started_counts[PerfCounters::kHowMany];
+    AllocationCounter::Counts allocations;
+    AllocationCounter::Counts started_allocations;
+  };
+
+/****************************************************************
+ * The tree of one thread, with the phase it is in now, -1 if
+ * none, and its counters if we are counting.
+**/
+  struct ThreadTimes {
+    int thread_number;
+    int current;
+    std::vector<Phase> phases;
+    std::unique_ptr<PerfCounters> counters;
+  };
+
+  static bool is_counting_;
+  static bool is_enabled_;
+  static std::string counting_error_;
+  static Clock clock_;
+  static double nanoseconds_per_tick_;
+  static std::mutex threads_mutex_;
+  static std::vector<std::unique_ptr<ThreadTimes> > threads_;
+  static thread_local ThreadTimes* this_thread_;
+
+  ThreadTimes* times_;
+  int phase_;
+
+  ScopedTimer(const ScopedTimer& that);
+  ScopedTimer& operator=(const ScopedTimer& that);
+
+  static int FindChild(ThreadTimes* times, const char* name);
+  static ThreadTimes* GetThreadTimes();
+  static void WriteAllocations(std::ostream& out_stream,
+                               const ThreadTimes& times, int phase,
+                               int depth,
+                               const AllocationCounter::Counts* now_counts);
+  static void WriteCounts(std::ostream& out_stream, const ThreadTimes& times,
+                          int phase, int depth, const LONG* now_counts);
+  static void WritePhase(std::ostream& out_stream, const ThreadTimes& times,
+                         int phase, int depth, LONG now, double total);
+};
+
+/****************************************************************
+ * Function 'Now', the time in ticks of the clock in use. For the
+ * monotonic clock a tick is a nanosecond.
+**/
+inline LONG ScopedTimer::Now() {
+#if defined(__x86_64__) || defined(__i386__)
+  if (kClockTSC == clock_) {
+    return static_cast<LONG>(__rdtsc());
+  }
+#endif
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<LONG>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
+
+/****************************************************************
+ * Constructor, which enters the phase 'name' below the phase the
+ * thread is in now. 'name' must last as long as the program, as
+ * a string literal does. When timing is not enabled this does
+ * nothing.
+**/
+inline ScopedTimer::ScopedTimer(const char* name) {
+  times_ = NULL;
+  phase_ = -1;
+  if (!is_enabled_) {
+    return;
+  }
+  times_ = GetThreadTimes();
+  phase_ = FindChild(times_, name);
+  Phase& phase = times_->phases[phase_];
+  phase.is_running = true;
+  times_->current = phase_;
+  if (NULL != times_->counters) {
+    times_->counters->Read(phase.started_counts);
+  }
+  phase.started_allocations = AllocationCounter::GetThreadCounts();
+  phase.started = Now();
+}
+
+/****************************************************************
+ * Destructor, which leaves the phase and adds the time in it.
+**/
+inline ScopedTimer::~ScopedTimer() {
+  if (NULL == times_) {
+    return;
+  }
+  LONG now = Now();
+  Phase& phase = times_->phases[phase_];
+  phase.ticks += now - phase.started;
+  if (NULL != times_->counters) {
+    LONG counts[PerfCounters::kHowMany];
+    times_->counters->Read(counts);
+    for (int counter = 0; counter < PerfCounters::kHowMany; ++counter) {
+      phase.counts[counter] += counts[counter] - phase.started_counts[counter];
+    }
+  }
+  AllocationCounter::Counts allocations = AllocationCounter::GetThreadCounts();
+  phase.allocations.allocations += allocations.allocations -
+                                   phase.started_allocations.allocations;
+  phase.allocations.frees += allocations.frees -
+                             phase.started_allocations.frees;
+  phase.allocations.bytes += allocations.bytes -
+                             phase.started_allocations.bytes;
+  ++phase.calls;
+  phase.is_running = false;
+  times_->current = phase.parent;
+}
+
+#endif // SCOPEDTIMER_H_
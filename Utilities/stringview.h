@@ -0,0 +1,96 @@
+/****************************************************************
+ * Header for the 'StringView' class.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+ * A 'StringView' is a pointer and a length into characters that
+ * belong to someone else, such as a 'Scanner' that has mapped a
+ * file. It does not own or copy the characters, so it is only
+ * good as long as they are.
+ *
+ * This is the part of C++17's 'std::string_view' that we need,
+ * with the same names, so that it can become a 'typedef' when
+ * the compiler moves past C++11.
+**/
+
+#ifndef STRINGVIEW_H_
+#define STRINGVIEW_H_
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+class StringView {
+public:
+  static const size_t npos = static_cast<size_t>(-1);
+
+/****************************************************************
+ * Constructors.
+**/
+  StringView() : data_(NULL), length_(0) {}
+  StringView(const char* data, size_t length)
+      : data_(data), length_(length) {}
+  StringView(const char* data) : data_(data), length_(strlen(data)) {}
+  StringView(const std::string& text)
+      : data_(text.data()), length_(text.length()) {}
+
+/****************************************************************
+ * Accessors.
+**/
+  const char* begin() const { return data_; }
+  const char* data() const { return data_; }
+  bool empty() const { return 0 == length_; }
+  const char* end() const { return data_ + length_; }
+  size_t length() const { return length_; }
+  size_t size() const { return length_; }
+  char operator[](size_t sub) const { return data_[sub]; }
+
+/****************************************************************
+ * General functions.
+**/
+  size_t find(char c, size_t pos = 0) const {
+    if (pos >= length_) return npos;
+    const void* found = memchr(data_ + pos, c, length_ - pos);
+    return (NULL == found) ? npos
+                           : static_cast<const char*>(found) - data_;
+  }
+
+  void remove_prefix(size_t how_many) {
+    data_ += how_many;
+    length_ -= how_many;
+  }
+
+  void remove_suffix(size_t how_many) {
+    length_ -= how_many;
+  }
+
+  StringView substr(size_t pos, size_t count = npos) const {
+    if (pos > length_) pos = length_;
+    if (count > length_ - pos) count = length_ - pos;
+    return StringView(data_ + pos, count);
+  }
+
+  std::string ToString() const {
+    return std::string(data_, length_);
+  }
+
+  bool operator==(const StringView& that) const {
+    return (length_ == that.length_) &&
+           ((0 == length_) || (0 == memcmp(data_, that.data_, length_)));
+  }
+
+  bool operator!=(const StringView& that) const {
+    return !(*this == that);
+  }
+
+private:
+  const char* data_;
+  size_t length_;
+};
+
+inline std::ostream& operator<<(std::ostream& out_stream, StringView view) {
+  return out_stream.write(view.data(), view.length());
+}
+
+#endif // STRINGVIEW_H_
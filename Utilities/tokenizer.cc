@@ -0,0 +1,84 @@
+#include "tokenizer.h"
+
+/****************************************************************
+ * Constructor.
+**/
+Tokenizer::Tokenizer() {
+  next_ = NULL;
+  end_ = NULL;
+}
+
+/****************************************************************
+ * Destructor.
+**/
+Tokenizer::~Tokenizer() {
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function 'HasMoreData'.
+ *
+ * Returns:
+ *   true if there are ANY more characters, whitespace or not
+**/
+bool Tokenizer::HasMoreData() const {
+  return next_ < end_;
+}
+
+/****************************************************************
+ * Function 'HasNext'. This skips the whitespace up to the next
+ * token.
+ *
+ * Returns:
+ *   true if there is another token
+**/
+bool Tokenizer::HasNext() {
+  next_ = SkipWhitespace(next_, end_);
+  return next_ < end_;
+}
+
+/****************************************************************
+ * Function 'Next'.
+ *
+ * Returns:
+ *   the next token, empty if there is none
+**/
+StringView Tokenizer::Next() {
+  const char* start = SkipWhitespace(next_, end_);
+  next_ = FindWhitespace(start, end_);
+  return StringView(start, next_ - start);
+}
+
+/****************************************************************
+ * Function 'NextLine'.
+ *
+ * Returns:
+ *   the rest of the line, without the newline
+**/
+StringView Tokenizer::NextLine() {
+  const char* start = next_;
+  const char* newline = FindNewline(next_, end_);
+  next_ = (newline < end_) ? newline + 1 : end_;
+  return StringView(start, newline - start);
+}
+
+/****************************************************************
+ * Function 'Open', to start on new text. The text is not copied,
+ * so it must last as long as the tokens are used.
+**/
+void Tokenizer::Open(StringView text) {
+  next_ = text.data();
+  end_ = text.data() + text.length();
+}
+
+/****************************************************************
+ * Function 'Rest'.
+ *
+ * Returns:
+ *   the text that has not yet been tokenized
+**/
+StringView Tokenizer::Rest() const {
+  return StringView(next_, end_ - next_);
+}
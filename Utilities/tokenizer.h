@@ -0,0 +1,213 @@
+/****************************************************************
+ * Header for the 'Tokenizer' class.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+ * This code finds the tokens in text that is already in memory,
+ * a token being anything other than whitespace. It is the core
+ * that 'ScanLine' and 'Scanner' are built on.
+**/
+
+#ifndef TOKENIZER_H_
+#define TOKENIZER_H_
+
+#include <cstring>
+#include <string>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "stringview.h"
+
+class Tokenizer {
+public:
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+  Tokenizer();
+  virtual ~Tokenizer();
+
+/****************************************************************
+ * General functions.
+**/
+  bool HasMoreData() const;
+  bool HasNext();
+  StringView Next();
+  StringView NextLine();
+  void Open(StringView text);
+  StringView Rest() const;
+
+/****************************************************************
+ * The search functions that do the work, for callers that keep
+ * their own place in the text. Each returns 'end' if it finds
+ * nothing.
+**/
+  static const char* FindNewline(const char* next, const char* end);
+  static const char* FindWhitespace(const char* next, const char* end);
+  static bool IsWhitespace(char c);
+  static const char* SkipWhitespace(const char* next, const char* end);
+
+private:
+  const char* next_;
+  const char* end_;
+
+#ifdef __SSE2__
+  static int WhitespaceMask16(const char* where);
+#endif
+#ifdef __AVX2__
+  static unsigned int WhitespaceMask32(const char* where);
+#endif
+};
+
+/****************************************************************
+ * Function for whether a character separates tokens: blank,
+ * tab, newline, vertical tab, form feed, or carriage return.
+**/
+inline bool Tokenizer::IsWhitespace(char c) {
+  return (' ' == c) || (('\t' <= c) && (c <= '\r'));
+}
+
+/****************************************************************
+ * The searches are on the path of every token, so they are here
+ * in the header to be inlined.
+ *
+ * The searches look at the text a block at a time, 32 bytes with
+ * AVX2 or 16 with SSE2, comparing every byte of the block against
+ * the whitespace characters at once and turning the result into
+ * a bit mask, one bit per byte. The first bit set in the mask, or
+ * clear when we are skipping whitespace, is where the search
+ * stops. Whatever is left at the end, less than a block, is done
+ * a byte at a time, as is everything on a machine with neither.
+ *
+ * A byte is whitespace if it is a blank, or if it is 9 through 13,
+ * tab through carriage return. Subtracting 9 takes the second
+ * range to 0 through 4 and every other byte above 4 as unsigned,
+ * so that test is one subtract, one unsigned minimum, and one
+ * compare for equality.
+**/
+
+#ifdef __SSE2__
+/****************************************************************
+ * The mask of the whitespace in 16 bytes.
+**/
+inline int Tokenizer::WhitespaceMask16(const char* where) {
+  const __m128i bytes =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(where));
+  const __m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+  const __m128i is_control = _mm_cmpeq_epi8(
+      _mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+  const __m128i is_blank = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+  return _mm_movemask_epi8(_mm_or_si128(is_control, is_blank));
+}
+#endif
+
+#ifdef __AVX2__
+/****************************************************************
+ * The mask of the whitespace in 32 bytes.
+**/
+inline unsigned int Tokenizer::WhitespaceMask32(const char* where) {
+  const __m256i bytes =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(where));
+  const __m256i shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+  const __m256i is_control = _mm256_cmpeq_epi8(
+      _mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+  const __m256i is_blank = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+  return static_cast<unsigned int>(
+      _mm256_movemask_epi8(_mm256_or_si256(is_control, is_blank)));
+}
+#endif
+
+/****************************************************************
+ * Function 'FindNewline'.
+ *
+ * Returns:
+ *   the first newline from 'next' on, or 'end'
+**/
+inline const char* Tokenizer::FindNewline(const char* next,
+                                           const char* end) {
+  if (next >= end) {
+    return end;
+  }
+  const void* found = memchr(next, '\n', end - next);
+  return (NULL == found) ? end : static_cast<const char*>(found);
+}
+
+/****************************************************************
+ * Function 'FindWhitespace', for the end of a token.
+ *
+ * Returns:
+ *   the first whitespace from 'next' on, or 'end'
+**/
+inline const char* Tokenizer::FindWhitespace(const char* next,
+                                              const char* end) {
+#ifdef __AVX2__
+  while (end - next >= 32) {
+    unsigned int mask = WhitespaceMask32(next);
+    if (0 != mask) {
+      return next + __builtin_ctz(mask);
+    }
+    next += 32;
+  }
+#endif
+#ifdef __SSE2__
+  while (end - next >= 16) {
+    int mask = WhitespaceMask16(next);
+    if (0 != mask) {
+      return next + __builtin_ctz(mask);
+    }
+    next += 16;
+  }
+#endif
+  while ((next < end) && !IsWhitespace(*next)) {
+    ++next;
+  }
+  return next;
+}
+
+/****************************************************************
+ * Function 'SkipWhitespace', for the start of a token.
+ *
+ * Returns:
+ *   the first character from 'next' on that is not whitespace,
+ *   or 'end'
+**/
+inline const char* Tokenizer::SkipWhitespace(const char* next,
+                                              const char* end) {
+  // Most tokens are separated by one blank or one newline, so look
+  // at two bytes before going to the blocks.
+  if ((next < end) && !IsWhitespace(*next)) {
+    return next;
+  }
+  if ((end - next > 1) && !IsWhitespace(next[1])) {
+    return next + 1;
+  }
+#ifdef __AVX2__
+  while (end - next >= 32) {
+    unsigned int mask = ~WhitespaceMask32(next);
+    if (0 != mask) {
+      return next + __builtin_ctz(mask);
+    }
+    next += 32;
+  }
+#endif
+#ifdef __SSE2__
+  while (end - next >= 16) {
+    int mask = ~WhitespaceMask16(next) & 0xFFFF;
+    if (0 != mask) {
+      return next + __builtin_ctz(mask);
+    }
+    next += 16;
+  }
+#endif
+  while ((next < end) && IsWhitespace(*next)) {
+    ++next;
+  }
+  return next;
+}
+
+#endif // TOKENIZER_H_
@@ -0,0 +1,205 @@
+/****************************************************************
+ * Microbenchmark for the 'Tokenizer', against the 'stringstream'
+ * extraction that 'ScanLine' used to do.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+ * Usage: tokenizerbench [lines]
+ *
+ * We make text of the two kinds the Pullet16 reads, short signed
+ * hex data and lines of sixteen bits, with some blank lines and
+ * extra blanks, and then tokenize all of it each of these ways:
+ *   stream      - 'stringstream >> string' a line at a time, the
+ *                 old 'ScanLine'
+ *   scanline    - the 'ScanLine' built on the 'Tokenizer'
+ *   bytes       - a byte at a time loop over the text, returning
+ *                 spans, which is what the 'Tokenizer' does when
+ *                 there is no SIMD
+ *   tokenizer   - the 'Tokenizer' over the whole text, returning
+ *                 spans
+ *   scanner     - the 'Scanner' on a file of the text, returning
+ *                 'string' tokens with 'HasNext' and 'Next'
+ * Every way must find the same tokens, which we check by their
+ * count and their total length.
+**/
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "scanline.h"
+#include "scanner.h"
+#include "tokenizer.h"
+
+/****************************************************************
+ * What one way of tokenizing found, and how long it took.
+**/
+struct Result {
+  LONG how_many;
+  LONG total_length;
+  double seconds;
+};
+
+/****************************************************************
+ * Time one way of tokenizing, and report it.
+**/
+template <typename Function>
+static Result TimeIt(const char* name, Function tokenize) {
+  Result result;
+  result.how_many = 0;
+  result.total_length = 0;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  tokenize(result);
+  result.seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  double per_second = (result.seconds > 0.0)
+                    ? result.how_many / result.seconds : 0.0;
+  double nanoseconds = (result.how_many > 0)
+                     ? 1.0e9 * result.seconds / result.how_many : 0.0;
+  char line[160];
+  snprintf(line, sizeof(line), "%-10s %12lld %12.1f %10.2f %12.3f", name,
+           static_cast<long long>(result.how_many), per_second / 1.0e6,
+           nanoseconds, result.seconds);
+  std::cout << line << std::endl;
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  int how_many_lines = (argc > 1) ? atoi(argv[1]) : 2000000;
+
+  // The text, and the same text as lines for the line at a time ways.
+  std::string text;
+  unsigned int seed = 12345;
+  for (int sub = 0; sub < how_many_lines; ++sub) {
+    seed = seed * 1103515245 + 12345;
+    int kind = (seed >> 16) % 8;
+    char token[40];
+    if (0 == kind) {
+      text += "\n";
+    } else if (kind <= 2) {
+      for (int bit = 15; bit >= 0; --bit) {
+        token[15 - bit] = ((seed >> (bit % 16)) & 1) ? '1' : '0';
+      }
+      token[16] = '\0';
+      text += token;
+      text += "\n";
+    } else {
+      int value = static_cast<int>((seed >> 8) % 65536) - 32768;
+      snprintf(token, sizeof(token), "%c%04X", (value < 0) ? '-' : '+',
+               (value < 0) ? -value : value);
+      text += token;
+      text += (kind == 7) ? "   " : " ";
+      snprintf(token, sizeof(token), "+%04X", (seed >> 4) % 65536);
+      text += token;
+      text += "\n";
+    }
+  }
+  std::vector<std::string> lines;
+  std::istringstream text_stream(text);
+  std::string one_line;
+  while (getline(text_stream, one_line)) {
+    lines.push_back(one_line);
+  }
+
+  char filename[] = "/tmp/tokenizerbenchXXXXXX";
+  int file_descriptor = mkstemp(filename);
+  if ((file_descriptor < 0) ||
+      (write(file_descriptor, text.data(), text.length()) !=
+       static_cast<ssize_t>(text.length()))) {
+    std::cout << "unable to write the test file" << std::endl;
+    return 1;
+  }
+  close(file_descriptor);
+
+  std::cout << "TOKENIZING " << text.length() << " BYTES IN "
+            << lines.size() << " LINES" << std::endl;
+  std::cout << "WAY              TOKENS     MTOKENS/S   NS/TOKEN"
+            << "      SECONDS" << std::endl;
+
+  std::vector<Result> results;
+  results.push_back(TimeIt("stream", [&lines](Result& result) {
+    std::stringstream line_stream;
+    std::string token;
+    for (auto iter = lines.begin(); iter != lines.end(); ++iter) {
+      line_stream.clear();
+      line_stream.str(*iter);
+      while (line_stream >> token) {
+        ++result.how_many;
+        result.total_length += token.length();
+      }
+    }
+  }));
+
+  results.push_back(TimeIt("scanline", [&lines](Result& result) {
+    ScanLine scanline;
+    for (auto iter = lines.begin(); iter != lines.end(); ++iter) {
+      scanline.OpenString(*iter);
+      while (scanline.HasNext()) {
+        std::string token = scanline.Next();
+        ++result.how_many;
+        result.total_length += token.length();
+      }
+    }
+  }));
+
+  results.push_back(TimeIt("bytes", [&text](Result& result) {
+    const char* next = text.data();
+    const char* end = next + text.length();
+    while (true) {
+      while ((next < end) && Tokenizer::IsWhitespace(*next)) {
+        ++next;
+      }
+      if (next == end) {
+        break;
+      }
+      const char* start = next;
+      while ((next < end) && !Tokenizer::IsWhitespace(*next)) {
+        ++next;
+      }
+      ++result.how_many;
+      result.total_length += next - start;
+    }
+  }));
+
+  results.push_back(TimeIt("tokenizer", [&text](Result& result) {
+    Tokenizer tokenizer;
+    tokenizer.Open(text);
+    while (tokenizer.HasNext()) {
+      StringView token = tokenizer.Next();
+      ++result.how_many;
+      result.total_length += token.length();
+    }
+  }));
+
+  results.push_back(TimeIt("scanner", [&filename](Result& result) {
+    int scanner_descriptor = open(filename, O_RDONLY);
+    Scanner scanner;
+    scanner.OpenDescriptor(scanner_descriptor);
+    while (scanner.HasNext()) {
+      std::string token = scanner.Next();
+      ++result.how_many;
+      result.total_length += token.length();
+    }
+    scanner.Close();
+    close(scanner_descriptor);
+  }));
+  unlink(filename);
+
+  for (auto iter = results.begin(); iter != results.end(); ++iter) {
+    if ((iter->how_many != results[0].how_many) ||
+        (iter->total_length != results[0].total_length)) {
+      std::cout << "THE WAYS FOUND DIFFERENT TOKENS" << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -1,11 +1,171 @@
 #include "utils.h"
 
+#include <cerrno>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 static const std::string kTag = "UTILS: ";
-static const std::string WHITESPACE = " \n\t\r";
 
-std::ofstream Utils::log_stream;
-std::ostringstream Utils::oss;
-std::stringstream Utils::ss;
+LogSink Utils::log_stream;
+thread_local std::ostringstream Utils::oss;
+thread_local std::stringstream Utils::ss;
+
+// Tables for the formatting into buffers. 'kDigitPairs' has the two
+// digits of every number 00 through 99, and 'kNibbleBits' has the four
+// bits of every hex digit.
+static const char kDigitPairs[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233"
+  "34353637383940414243444546474849505152535455565758596061626364656667"
+  "6869707172737475767778798081828384858687888990919293949596979899";
+static const char kNibbleBits[] =
+  "0000000100100011010001010110011110001001101010111100110111101111";
+static const char kHexDigits[] = "0123456789ABCDEF";
+
+/****************************************************************
+ * Write a magnitude and sign, right justified in 'width', into a
+ * buffer. This is the common part of the 'FormatInto' functions.
+**/
+static int FormatDigits(char* buffer, uint64_t magnitude, bool is_negative,
+                        const int width) {
+  char digits[24];
+  char* end = digits + sizeof(digits);
+  char* start = end;
+  while (magnitude >= 100) {
+    const char* pair = kDigitPairs + 2 * (magnitude % 100);
+    magnitude /= 100;
+    *--start = pair[1];
+    *--start = pair[0];
+  }
+  if (magnitude >= 10) {
+    const char* pair = kDigitPairs + 2 * magnitude;
+    *--start = pair[1];
+    *--start = pair[0];
+  } else {
+    *--start = static_cast<char>('0' + magnitude);
+  }
+  if (is_negative) {
+    *--start = '-';
+  }
+
+  int length = static_cast<int>(end - start);
+  int padding = (width > length) ? width - length : 0;
+  for (int i = 0; i < padding; ++i) {
+    buffer[i] = ' ';
+  }
+  for (int i = 0; i < length; ++i) {
+    buffer[padding + i] = start[i];
+  }
+  buffer[padding + length] = '\0';
+  return padding + length;
+}
+
+/****************************************************************
+ * The same, but returning a 'string' and with no limit on 'width'.
+ * This is what the 'Format' functions for integers use.
+**/
+static std::string FormatString(LONG value, const int width) {
+  bool is_negative = value < 0;
+  uint64_t magnitude = is_negative ? 0 - static_cast<uint64_t>(value)
+                                   : static_cast<uint64_t>(value);
+  char buffer[Utils::kFormatBufferSize];
+  int length = FormatDigits(buffer, magnitude, is_negative, 0);
+  std::string result;
+  if (width > length) {
+    result.assign(width - length, ' ');
+  }
+  result.append(buffer, length);
+  return result;
+}
+
+/****************************************************************
+ * The value of a digit in bases up to 16, upper or lower case,
+ * or 16 for anything that is not a digit.
+**/
+static inline int DigitValue(const char c) {
+  UINT decimal = static_cast<UINT>(static_cast<unsigned char>(c)) - '0';
+  if (decimal < 10) {
+    return static_cast<int>(decimal);
+  }
+  UINT letter = static_cast<UINT>(static_cast<unsigned char>(c) | 0x20) - 'a';
+  return (letter < 6) ? static_cast<int>(letter) + 10 : 16;
+}
+
+/****************************************************************
+ * Parse a sign, if there is one, and digits in 'base'. The value
+ * may be at most 'limit', or 'limit' + 1 if it is negative. This
+ * is the common part of the integer 'Parse' functions.
+ *
+ * The test for overflow is the one 'strtol' uses: the largest
+ * value that can take another digit is found once, so there is
+ * no division per digit.
+**/
+static inline Utils::ParseError ParseInteger(StringView text, const int base,
+                                             const uint64_t limit,
+                                             LONG& value) {
+  value = 0;
+  const char* next = text.begin();
+  const char* end = text.end();
+  if (next == end) {
+    return Utils::kParseEmpty;
+  }
+  bool is_negative = ('-' == *next);
+  if (is_negative || ('+' == *next)) {
+    ++next;
+    if (next == end) {
+      return Utils::kParseInvalid;
+    }
+  }
+
+  uint64_t most = is_negative ? limit + 1 : limit;
+  uint64_t cutoff = most / base;
+  int cutoff_digit = static_cast<int>(most % base);
+  uint64_t magnitude = 0;
+  bool is_out_of_range = false;
+  for (; next < end; ++next) {
+    int digit = DigitValue(*next);
+    if (digit >= base) {
+      return Utils::kParseInvalid;
+    }
+    if ((magnitude > cutoff) ||
+        ((magnitude == cutoff) && (digit > cutoff_digit))) {
+      is_out_of_range = true;
+    } else {
+      magnitude = magnitude * base + digit;
+    }
+  }
+  if (is_out_of_range) {
+    return Utils::kParseOutOfRange;
+  }
+
+  value = is_negative ? static_cast<LONG>(0 - magnitude)
+                      : static_cast<LONG>(magnitude);
+  return Utils::kParseOK;
+}
+
+/****************************************************************
+ * Parse an integer that must fit in an 'int'.
+**/
+static inline Utils::Parsed<int> ParseIntInBase(StringView text,
+                                                const int base) {
+  LONG value = 0;
+  Utils::Parsed<int> result;
+  result.error = ParseInteger(text, base, 0x7FFFFFFF, value);
+  result.value = static_cast<int>(value);
+  return result;
+}
+
+/****************************************************************
+ * The powers of ten that are exact as a 'double'.
+**/
+static const double kExactPowersOfTen[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
 
 /****************************************************************
  * Constructor.
@@ -40,6 +200,23 @@ void Utils::CheckArgs(const int howMany, const int argc,
   }
 }
 
+/****************************************************************
+ * Close an input file that was opened as a file descriptor.
+ *
+ * Parameters:
+ *   file_descriptor - the file descriptor by reference, which
+ *                     is set to -1
+ * Return: none
+**/
+void Utils::FileClose(int& file_descriptor) {
+  std::cout << kTag << "close the input file" << std::endl;
+  if (file_descriptor >= 0) {
+    close(file_descriptor);
+  }
+  file_descriptor = -1;
+  std::cout << kTag << "the input file was closed" << std::endl;
+}
+
 /****************************************************************
  * Close an input stream.
  *
@@ -66,6 +243,19 @@ void Utils::FileClose(std::ofstream& out_stream) {
   std::cout << kTag << "the output file was closed" << std::endl;
 }
 
+/****************************************************************
+ * Close the log stream, writing out whatever is still buffered.
+ *
+ * Parameters:
+ *   log_stream - the 'LogSink' log stream by reference
+ * Return: none
+**/
+void Utils::FileClose(LogSink& log_stream) {
+  std::cout << kTag << "close the output file" << std::endl;
+  log_stream.close();
+  std::cout << kTag << "the output file was closed" << std::endl;
+}
+
 /****************************************************************
  * Check to see if a file does exist.
  * This is done by attempting to open the file.
@@ -123,6 +313,25 @@ bool Utils::FileDoesNotExist(std::string filename) {
   return return_value;
 }
 
+/****************************************************************
+ * Open an input file as a file descriptor, for reading with
+ * 'read' or 'mmap' rather than through a stream.
+ *
+ * Parameters:
+ *   file_descriptor - the file descriptor by reference
+ *   filename - the name of the file to be opened
+ * Return: none
+**/
+void Utils::FileOpen(int& file_descriptor, std::string filename) {
+  std::cout << kTag << "open the input file '" << filename << "'" << std::endl;
+  file_descriptor = open(filename.c_str(), O_RDONLY);
+  if(file_descriptor < 0) {
+    std::cout << kTag << "open failed for '" << filename << "'" << std::endl;
+    exit(0);
+  }
+  std::cout << kTag << "open succeeded for '" << filename << "'" << std::endl;
+}
+
 /****************************************************************
  * Open an input stream.
  *
@@ -319,9 +528,7 @@ std::string Utils::Format(const std::string value, const int width,
  * Return: the string-ified version of 'value'
 **/
 std::string Utils::Format(const short value) {
-  Utils::oss.str("");
-  Utils::oss << value;
-  return oss.str();
+  return FormatString(static_cast<LONG>(value), 0);
 }
 
 /****************************************************************
@@ -334,10 +541,7 @@ std::string Utils::Format(const short value) {
  * Return: the string-ified version of 'value'
 **/
 std::string Utils::Format(const short value, const int width) {
-  Utils::oss.str("");
-  Utils::oss.setf(std::ios::right, std::ios::adjustfield);
-  Utils::oss << std::setw(width) << value;
-  return oss.str();
+  return FormatString(static_cast<LONG>(value), width);
 }
 
 /****************************************************************
@@ -349,9 +553,7 @@ std::string Utils::Format(const short value, const int width) {
  * Return: the string-ified version of 'value'
 **/
 std::string Utils::Format(const int value) {
-  Utils::oss.str("");
-  Utils::oss << value;
-  return oss.str();
+  return FormatString(static_cast<LONG>(value), 0);
 }
 
 /****************************************************************
@@ -364,10 +566,7 @@ std::string Utils::Format(const int value) {
  * Return: the string-ified version of 'value'
 **/
 std::string Utils::Format(const int value, const int width) {
-  Utils::oss.str("");
-  Utils::oss.setf(std::ios::right, std::ios::adjustfield);
-  Utils::oss << std::setw(width) << value;
-  return oss.str();
+  return FormatString(static_cast<LONG>(value), width);
 }
 
 /****************************************************************
@@ -379,9 +578,7 @@ std::string Utils::Format(const int value, const int width) {
  * Return: the string-ified version of 'value'
 **/
 std::string Utils::Format(const UINT value) {
-  Utils::oss.str("");
-  Utils::oss << value;
-  return oss.str();
+  return FormatString(static_cast<LONG>(value), 0);
 }
 
 /****************************************************************
@@ -394,10 +591,7 @@ std::string Utils::Format(const UINT value) {
  * Return: the string-ified version of 'value'
 **/
 std::string Utils::Format(const UINT value, const int width) {
-  Utils::oss.str("");
-  Utils::oss.setf(std::ios::right, std::ios::adjustfield);
-  Utils::oss << std::setw(width) << value;
-  return oss.str();
+  return FormatString(static_cast<LONG>(value), width);
 }
 
 /****************************************************************
@@ -409,9 +603,7 @@ std::string Utils::Format(const UINT value, const int width) {
  * Return: the string-ified version of 'value'
 **/
 std::string Utils::Format(const LONG value) {
-  Utils::oss.str("");
-  Utils::oss << value;
-  return oss.str();
+  return FormatString(static_cast<LONG>(value), 0);
 }
 
 /****************************************************************
@@ -424,11 +616,7 @@ std::string Utils::Format(const LONG value) {
  * Return: the string-ified version of 'value'
 **/
 std::string Utils::Format(const LONG value, const int width) {
-  int localWidth = static_cast<int>(width);
-  Utils::oss.str("");
-  Utils::oss.setf(std::ios::right, std::ios::adjustfield);
-  Utils::oss << std::setw(localWidth) << value;
-  return oss.str();
+  return FormatString(static_cast<LONG>(value), width);
 }
 
 /****************************************************************
@@ -489,6 +677,328 @@ std::string Utils::Format(const double value, const int width,
   return returnString;
 }
 
+/****************************************************************
+ * Write the bits of the low 'how_many_bits' of 'value' into a
+ * buffer, the same text as 'std::bitset<how_many_bits>::to_string'.
+ * The bits are done four at a time from a table.
+ *
+ * Parameters:
+ *   buffer - where to write, with room for 'how_many_bits' + 1 chars
+ *   value - the value whose bits are written
+ *   how_many_bits - the number of bits, a multiple of 4 up to 32
+ * Return: the number of chars written, not counting the final null
+**/
+int Utils::BitsInto(char* buffer, const int value, const int how_many_bits) {
+  UINT bits = static_cast<UINT>(value);
+  int length = 0;
+  for (int shift = how_many_bits - 4; shift >= 0; shift -= 4) {
+    const char* nibble = kNibbleBits + 4 * ((bits >> shift) & 15);
+    buffer[length] = nibble[0];
+    buffer[length + 1] = nibble[1];
+    buffer[length + 2] = nibble[2];
+    buffer[length + 3] = nibble[3];
+    length += 4;
+  }
+  buffer[length] = '\0';
+  return length;
+}
+
+/****************************************************************
+ * Write an 'int' into a buffer, right justified in 'width', the same
+ * text as 'Format(value, width)' but with no stream and no allocation.
+ *
+ * Parameters:
+ *   buffer - where to write, with room for 'kFormatBufferSize' chars
+ *   value - the 'int' to be written
+ *   width - the width of the field, at most 'kFormatBufferSize' - 1
+ * Return: the number of chars written, not counting the final null
+**/
+int Utils::FormatInto(char* buffer, const int value, const int width) {
+  return Utils::FormatInto(buffer, static_cast<LONG>(value), width);
+}
+
+/****************************************************************
+ * Write a 'LONG' into a buffer, right justified in 'width'.
+ *
+ * Parameters:
+ *   buffer - where to write, with room for 'kFormatBufferSize' chars
+ *   value - the 'LONG' to be written
+ *   width - the width of the field, at most 'kFormatBufferSize' - 1
+ * Return: the number of chars written, not counting the final null
+**/
+int Utils::FormatInto(char* buffer, const LONG value, const int width) {
+  bool is_negative = value < 0;
+  uint64_t magnitude = is_negative ? 0 - static_cast<uint64_t>(value)
+                                   : static_cast<uint64_t>(value);
+  return FormatDigits(buffer, magnitude, is_negative, width);
+}
+
+/****************************************************************
+ * Write the low 'how_many_digits' hex digits of 'value' into a
+ * buffer, in upper case and with leading zeros.
+ *
+ * Parameters:
+ *   buffer - where to write, with room for 'how_many_digits' + 1 chars
+ *   value - the value to be written
+ *   how_many_digits - the number of digits, at most 8
+ * Return: the number of chars written, not counting the final null
+**/
+int Utils::HexInto(char* buffer, const int value, const int how_many_digits) {
+  UINT bits = static_cast<UINT>(value);
+  for (int i = how_many_digits - 1; i >= 0; --i) {
+    buffer[i] = kHexDigits[bits & 15];
+    bits >>= 4;
+  }
+  buffer[how_many_digits] = '\0';
+  return how_many_digits;
+}
+
+/****************************************************************
+ * Write a blank and the 16 bits of each of 'how_many' words into a
+ * buffer, which is the memory dump format. This is
+ * 'BitsInto(value, 16)' for each word, but with SSE2 a word is
+ * expanded to its 16 chars of '0' and '1' in one register: the high
+ * byte is spread over the first 8 bytes and the low byte over the
+ * last 8, each byte is tested against its own bit, and the result
+ * is subtracted from a vector of '0'. Four words are done per pass.
+ *
+ * Parameters:
+ *   buffer - where to write, with room for 17 * 'how_many' + 1 chars
+ *   words - the words to be written
+ *   how_many - the number of words
+ * Return: the number of chars written, not counting the final null
+**/
+int Utils::WordBitsInto(char* buffer, const int* words, const int how_many) {
+  char* out = buffer;
+  int i = 0;
+#ifdef __SSE2__
+  const __m128i bit_masks = _mm_setr_epi8(
+      static_cast<char>(0x80), 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+      static_cast<char>(0x80), 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+  const __m128i zeros = _mm_set1_epi8('0');
+  for (; i + 4 <= how_many; i += 4) {
+    for (int j = 0; j < 4; ++j) {
+      int word = words[i + j];
+      __m128i bytes = _mm_unpacklo_epi64(
+          _mm_set1_epi8(static_cast<char>(word >> 8)),
+          _mm_set1_epi8(static_cast<char>(word)));
+      __m128i is_set = _mm_cmpeq_epi8(_mm_and_si128(bytes, bit_masks),
+                                      bit_masks);
+      out[0] = ' ';
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 1),
+                       _mm_sub_epi8(zeros, is_set));
+      out += 17;
+    }
+  }
+#endif
+  for (; i < how_many; ++i) {
+    *out++ = ' ';
+    out += Utils::BitsInto(out, words[i], 16);
+  }
+  *out = '\0';
+  return static_cast<int>(out - buffer);
+}
+
+/****************************************************************
+ * Parse a binary number, as in the bit strings of the Pullet16.
+ *
+ * Parameters:
+ *   text - the number, with no blanks
+ * Returns:
+ *   the value, or zero and the error
+**/
+Utils::Parsed<int> Utils::ParseBinary(StringView text) {
+  return ParseIntInBase(text, 2);
+}
+
+/****************************************************************
+ * Parse a 'double': a sign, digits with or without a decimal
+ * point, and an exponent, the same numbers 'atof' takes except
+ * that there may be nothing else in 'text' and there are no hex
+ * floats, infinities, or NaNs.
+ *
+ * If there are at most 19 significant digits we have them in an
+ * integer, and if that is at most 2^53 and the power of ten is
+ * at most 22 then both are exact as 'double' and one multiply or
+ * divide gives the correctly rounded value. Anything else is
+ * handed to 'strtod', from a copy in a buffer on the stack since
+ * 'text' need not end in a null.
+ *
+ * Parameters:
+ *   text - the number, with no blanks
+ * Returns:
+ *   the value, or zero and the error
+**/
+Utils::Parsed<double> Utils::ParseDouble(StringView text) {
+  Parsed<double> result;
+  result.value = 0.0;
+  result.error = kParseOK;
+  const char* next = text.begin();
+  const char* end = text.end();
+  if (next == end) {
+    result.error = kParseEmpty;
+    return result;
+  }
+
+  bool is_negative = ('-' == *next);
+  if (is_negative || ('+' == *next)) {
+    ++next;
+  }
+
+  // The significant digits go into 'mantissa' and 'exponent' is
+  // the power of ten it is to be multiplied by.
+  uint64_t mantissa = 0;
+  int how_many_digits = 0;
+  int exponent = 0;
+  bool has_digits = false;
+  bool is_truncated = false;
+  bool is_fraction = false;
+  for (; next < end; ++next) {
+    if (('.' == *next) && !is_fraction) {
+      is_fraction = true;
+      continue;
+    }
+    UINT digit = static_cast<UINT>(static_cast<unsigned char>(*next)) - '0';
+    if (digit > 9) {
+      break;
+    }
+    has_digits = true;
+    if ((0 == mantissa) && (0 == digit)) {
+      exponent -= is_fraction ? 1 : 0;
+    } else if (how_many_digits < 19) {
+      mantissa = 10 * mantissa + digit;
+      ++how_many_digits;
+      exponent -= is_fraction ? 1 : 0;
+    } else {
+      is_truncated = is_truncated || (0 != digit);
+      exponent += is_fraction ? 0 : 1;
+    }
+  }
+  if (!has_digits) {
+    result.error = kParseInvalid;
+    return result;
+  }
+
+  if ((next < end) && (('e' == *next) || ('E' == *next))) {
+    ++next;
+    bool is_negative_exponent = (next < end) && ('-' == *next);
+    if ((next < end) && (('-' == *next) || ('+' == *next))) {
+      ++next;
+    }
+    if (next == end) {
+      result.error = kParseInvalid;
+      return result;
+    }
+    int written_exponent = 0;
+    for (; next < end; ++next) {
+      UINT digit = static_cast<UINT>(static_cast<unsigned char>(*next)) - '0';
+      if (digit > 9) {
+        break;
+      }
+      if (written_exponent < 100000) {
+        written_exponent = 10 * written_exponent + digit;
+      }
+    }
+    exponent += is_negative_exponent ? -written_exponent : written_exponent;
+  }
+  if (next < end) {
+    result.error = kParseInvalid;
+    return result;
+  }
+
+  if (0 == mantissa) {
+    result.value = is_negative ? -0.0 : 0.0;
+    return result;
+  }
+  if (!is_truncated && (mantissa <= (static_cast<uint64_t>(1) << 53)) &&
+      (-22 <= exponent) && (exponent <= 22)) {
+    double value = static_cast<double>(mantissa);
+    value = (exponent < 0) ? value / kExactPowersOfTen[-exponent]
+                           : value * kExactPowersOfTen[exponent];
+    result.value = is_negative ? -value : value;
+    return result;
+  }
+
+  char buffer[64];
+  std::string long_text;
+  const char* copy = buffer;
+  if (text.length() < sizeof(buffer)) {
+    memcpy(buffer, text.data(), text.length());
+    buffer[text.length()] = '\0';
+  } else {
+    long_text = text.ToString();
+    copy = long_text.c_str();
+  }
+  errno = 0;
+  double value = strtod(copy, NULL);
+  if ((ERANGE == errno) && std::isinf(value)) {
+    result.error = kParseOutOfRange;
+    return result;
+  }
+  result.value = value;
+  return result;
+}
+
+/****************************************************************
+ * The words for a 'ParseError', for messages.
+ *
+ * Parameters:
+ *   error - the error
+ * Returns:
+ *   what the error means
+**/
+const char* Utils::ParseErrorName(ParseError error) {
+  switch (error) {
+    case kParseOK:
+      return "ok";
+    case kParseEmpty:
+      return "empty";
+    case kParseInvalid:
+      return "not a number";
+    case kParseOutOfRange:
+      return "out of range";
+  }
+  return "unknown error";
+}
+
+/****************************************************************
+ * Parse a hex number, upper or lower case, with no '0x'.
+ *
+ * Parameters:
+ *   text - the number, with no blanks
+ * Returns:
+ *   the value, or zero and the error
+**/
+Utils::Parsed<int> Utils::ParseHex(StringView text) {
+  return ParseIntInBase(text, 16);
+}
+
+/****************************************************************
+ * Parse a decimal 'int'.
+ *
+ * Parameters:
+ *   text - the number, with no blanks
+ * Returns:
+ *   the value, or zero and the error
+**/
+Utils::Parsed<int> Utils::ParseInt(StringView text) {
+  return ParseIntInBase(text, 10);
+}
+
+/****************************************************************
+ * Parse a decimal 'LONG'.
+ *
+ * Parameters:
+ *   text - the number, with no blanks
+ * Returns:
+ *   the value, or zero and the error
+**/
+Utils::Parsed<LONG> Utils::ParseLONG(StringView text) {
+  Parsed<LONG> result;
+  result.error = ParseInteger(text, 10, 0x7FFFFFFFFFFFFFFFULL, result.value);
+  return result;
+}
+
  /****************************************************************
  * Output function to one stream
 **/
@@ -516,26 +1026,37 @@ void Utils::Output(std::string outstring, std::ofstream& outstreamA,
  * instead of having embedded blanks. 
  *
  * Parameters:
- *   what - the input 'string' to trim blanks from
+ *   input - the input 'string' to replace blanks in
+ *   c - the character to replace them with
  * Returns:
- *   the 'what' string less any leading or trailing blanks
+ *   the 'input' string with every blank replaced by 'c'
 **/
 std::string Utils::ReplaceBlanks(std::string input, char c) {
-  std::string return_value;
-
-  return_value = input;
+  Utils::ReplaceBlanksInPlace(input, c);
+  return input;
+}
 
-  std::string::size_type pos = return_value.find(" ");
-  while(pos != std::string::npos) {
-    return_value[pos] = c;
-    pos = return_value.find(" ");
+/****************************************************************
+ * Replace the blanks in a 'string' with a character, in place,
+ * in one pass.
+ *
+ * Parameters:
+ *   text - the 'string' to replace blanks in
+ *   c - the character to replace them with
+**/
+void Utils::ReplaceBlanksInPlace(std::string& text, char c) {
+  for (std::string::iterator iter = text.begin(); iter != text.end();
+       ++iter) {
+    if (' ' == *iter) {
+      *iter = c;
+    }
   }
-
-  return return_value;
 }
 
 /****************************************************************
- * Convert a string to an integer.
+ * Convert a string to an integer. A string that is not an 'int'
+ * is logged and gives zero; callers that want to know should use
+ * 'ParseInt'.
  *
  * Parameters:
  *   input - the input 'string' to convert from
@@ -543,63 +1064,33 @@ std::string Utils::ReplaceBlanks(std::string input, char c) {
  *   the 'int' value of 'input'
 **/
 int Utils::StringToInteger(std::string input) {
-  bool is_negative;
-  int return_value = 0;
-  const std::string digits = "0123456789";
-
-//  Utils::log_stream << kTag << "string '" << input << "'\n";
-//  Utils::log_stream.flush();
-  is_negative = false;
-  if("-" == input.substr(0,1)) { 
-//    Utils::log_stream << kTag << "negative '" << input.substr(0,1) << "'\n";
-//    Utils::log_stream.flush();
-    is_negative = true;
-    input = input.substr(1);
-  }
-//  Utils::log_stream << kTag << "now pos '" << input << "'\n";
-//  Utils::log_stream.flush();
-
-//  for(std::string::iterator iter = input.begin(); iter != input.end(); ++iter) {
-  for(auto iter = input.begin(); iter != input.end(); ++iter) {
-    int digit = digits.find(*iter);
-    if((0 > digit) || (9 < digit)) {
-      Utils::log_stream << kTag << "ERROR: string '" << input
-                       << "' not a number\n";
-      Utils::log_stream.flush();
-      exit(0);
-    }
-    return_value = 10*return_value + digit;
+  Parsed<int> parsed = Utils::ParseInt(input);
+  if (!parsed.IsOK()) {
+    Utils::log_stream << kTag << "ERROR: string '" << input << "' "
+                      << Utils::ParseErrorName(parsed.error) << "\n";
+    Utils::log_stream.flush();
   }
-
-  if(is_negative) return_value = -return_value;
-
-  return return_value;
+  return parsed.value;
 } // int Utils::StringToInteger(string input)
 
 /****************************************************************
- * Convert a string to a LONG.
+ * Convert a string to a LONG. A string that is not a 'LONG' is
+ * logged and gives zero; callers that want to know should use
+ * 'ParseLONG'.
  *
  * Parameters:
  *   input - the input 'string' to convert from
  * Returns:
- *   the 'int' value of 'input'
+ *   the 'LONG' value of 'input'
 **/
 LONG Utils::StringToLONG(std::string input) {
-  LONG return_value = 0L;
-  const std::string digits = "0123456789";
-
-  for(auto iter = input.begin(); iter != input.end(); ++iter) {
-    int digit = digits.find(*iter);
-    if((0 > digit) || (9 < digit)) {
-      Utils::log_stream << kTag << "ERROR: string '" << input
-                       << "' not a number\n";
-      Utils::log_stream.flush();
-      exit(0);
-    }
-    return_value = 10*return_value + digit;
+  Parsed<LONG> parsed = Utils::ParseLONG(input);
+  if (!parsed.IsOK()) {
+    Utils::log_stream << kTag << "ERROR: string '" << input << "' "
+                      << Utils::ParseErrorName(parsed.error) << "\n";
+    Utils::log_stream.flush();
   }
-
-  return return_value;
+  return parsed.value;
 } // LONG Utils::StringToLONG(std::string input)
 
 /****************************************************************
@@ -729,28 +1220,29 @@ void Utils::ToLower(std::string& to, const std::string from) {
  *   the 'what' string less any leading or trailing blanks
 **/
 std::string Utils::TrimBlanks(std::string what) {
-  int length;
-  std::string return_value;
-
-  return_value = what;
+  return Utils::TrimBlanksView(what).ToString();
+} // std::string Utils::trimBlanks(std::string what)
 
-  // trim away leading blanks
-  while(" " == return_value.substr(0,1)) {
-    length = return_value.length();
-    return_value = return_value.substr(1,length);
+/****************************************************************
+ * Trim away leading and trailing blanks, by narrowing the view.
+ * Nothing is copied.
+ *
+ * Parameters:
+ *   what - the text to trim blanks from
+ * Returns:
+ *   the part of 'what' less any leading or trailing blanks
+**/
+StringView Utils::TrimBlanksView(StringView what) {
+  const char* start = what.begin();
+  const char* stop = what.end();
+  while ((start < stop) && (' ' == *start)) {
+    ++start;
   }
-
-  // trim away trailing blanks
-  if(!return_value.empty()) {
-    length = return_value.length();
-    while(" " == return_value.substr(length-1,1)) {
-      return_value = return_value.substr(0,length-1);
-      length = return_value.length();
-    }
+  while ((stop > start) && (' ' == stop[-1])) {
+    --stop;
   }
-
-  return return_value;
-} // std::string Utils::trimBlanks(std::string what)
+  return StringView(start, stop - start);
+}
 
 /****************************************************************
  * General function for trimming whitespace from begin and end.
@@ -761,40 +1253,33 @@ std::string Utils::TrimBlanks(std::string what) {
  *   the 's' string less any leading or trailing whitespace
 **/
 std::string Utils::Trim(std::string s) {
-  size_t foundPos = std::string::npos;
-  std::string return_string = s;
-
-#ifdef EBUG3
-  Utils::log_stream << kTag << "orig string: '" << return_string << "'"
-                            << std::endl;
-#endif
-
-  foundPos = return_string.find_first_not_of(WHITESPACE);
-#ifdef EBUG3
-  Utils::log_stream << kTag << "found first: " << foundPos
-                            << std::endl;
-#endif
-  if(foundPos != std::string::npos) {
-    return_string = s.substr(foundPos);
-  }
+  std::string return_string = Utils::TrimView(s).ToString();
 #ifdef EBUG3
+  Utils::log_stream << kTag << "orig string: '" << s << "'" << std::endl;
   Utils::log_stream << kTag << "new string:  '" << return_string << "'"
                             << std::endl;
 #endif
-
-  foundPos = return_string.find_last_not_of(WHITESPACE);
-#ifdef EBUG3
-  Utils::log_stream << kTag << "found last:  " << foundPos
-                            << std::endl;
-#endif
-  if(foundPos != std::string::npos)
-  {
-    return_string = return_string.substr(0,foundPos+1);
-  }
-#ifdef EBUG3
-  Utils::log_stream << kTag << "new string:  '" << return_string << "'"
-                            << std::endl;
-#endif
-
   return return_string;
 } // std::string Utils::Trim(std::string s)
+
+/****************************************************************
+ * Trim away leading and trailing whitespace, by narrowing the
+ * view. Nothing is copied, and text that is all whitespace comes
+ * back empty.
+ *
+ * Parameters:
+ *   what - the text to trim whitespace from
+ * Returns:
+ *   the part of 'what' less any leading or trailing whitespace
+**/
+StringView Utils::TrimView(StringView what) {
+  const char* start = what.begin();
+  const char* stop = what.end();
+  while ((start < stop) && (NULL != memchr(" \n\t\r", *start, 4))) {
+    ++start;
+  }
+  while ((stop > start) && (NULL != memchr(" \n\t\r", stop[-1], 4))) {
+    --stop;
+  }
+  return StringView(start, stop - start);
+}
@@ -27,6 +27,9 @@
 // #define NDEBUG
 #include <cassert>
 
+#include "logsink.h"
+#include "stringview.h"
+
 typedef unsigned int UINT;
 typedef int64_t LONG;
 
@@ -38,11 +41,15 @@ public:
 **/
 //  static ifstream inStream; //deprecated
 //  static ofstream outStream; //deprecated
-  static std::ofstream log_stream;
+  static LogSink log_stream;
 
 //  static stringstream utilsss(stringstream::in | stringstream::out);
-  static std::stringstream ss;
-  static std::ostringstream oss;
+/****************************************************************
+ * The scratch streams for 'Format' are one per thread, so that
+ * several threads can format at once.
+**/
+  static thread_local std::stringstream ss;
+  static thread_local std::ostringstream oss;
 
 /****************************************************************
  * Constructors and destructors for the class. 
@@ -59,10 +66,13 @@ public:
 /****************************************************************
  * file open and close functions
 **/
+  static void FileClose(int& file_descriptor);
   static void FileClose(std::ifstream& in_stream);
   static void FileClose(std::ofstream& out_stream);
+  static void FileClose(LogSink& log_stream);
   static bool FileDoesExist(const std::string filename);
   static bool FileDoesNotExist(const std::string filename);
+  static void FileOpen(int& file_descriptor, const std::string filename);
   static void FileOpen(std::ifstream& in_stream, const std::string filename);
   static void FileOpen(std::ofstream& out_stream, const std::string filename);
   static void InFileOpen(const std::string filename);
@@ -95,9 +105,44 @@ public:
   static std::string Format(const double value, const int width,
                             const int precision);
 
+/****************************************************************
+ * formatting into a caller's buffer, with no stream and no
+ * allocation, so that these are safe to call from any thread
+**/
+  static const int kFormatBufferSize = 32;
+
+  static int BitsInto(char* buffer, const int value, const int how_many_bits);
+  static int FormatInto(char* buffer, const int value, const int width);
+  static int FormatInto(char* buffer, const LONG value, const int width);
+  static int HexInto(char* buffer, const int value, const int how_many_digits);
+  static int WordBitsInto(char* buffer, const int* words, const int how_many);
+
 /****************************************************************
  * conversion functions
+ *
+ * The 'Parse' functions take all of 'text' as the number, with no
+ * blanks, and neither allocate nor exit on bad input; the result
+ * carries the value, zero if there is an error, and the error.
+ * Decimal, hex, and binary may have a sign.
 **/
+  enum ParseError {
+    kParseOK, kParseEmpty, kParseInvalid, kParseOutOfRange
+  };
+
+  template <typename T>
+  struct Parsed {
+    T value;
+    ParseError error;
+    bool IsOK() const { return kParseOK == error; }
+  };
+
+  static Parsed<int> ParseBinary(StringView text);
+  static Parsed<double> ParseDouble(StringView text);
+  static const char* ParseErrorName(ParseError error);
+  static Parsed<int> ParseHex(StringView text);
+  static Parsed<int> ParseInt(StringView text);
+  static Parsed<LONG> ParseLONG(StringView text);
+
   static int StringToInteger(std::string input);
   static LONG StringToLONG(std::string input);
 
@@ -107,11 +152,14 @@ public:
 //  static bool hasMoreData(ifstream& inStream);
 
   static std::string ReplaceBlanks(std::string input, char c);
+  static void ReplaceBlanksInPlace(std::string& text, char c);
   static std::string TimeCall(const std::string timestring);
   static std::string TimeCall(const std::string timestring, double& timenew);
   static void ToLower(std::string& to, const std::string from);
   static std::string TrimBlanks(std::string what);
+  static StringView TrimBlanksView(StringView what);
   static std::string Trim(std::string what);
+  static StringView TrimView(StringView what);
 
   static void Output(std::string outstring, std::ofstream& outstream);
   static void Output(std::string outstring, std::ofstream& outstreamA,
@@ -13,10 +13,16 @@
  *
 **/
 
+const char* Globals::kMnemonicNames[] = { "BAN", "SUB", "STC", "AND", "ADD",
+                                         "LD", "BR", "RD", "STP", "WRT",
+                                         "???" };
+
 /******************************************************************************
  * Function 'BitStringToDec'.
  * Convert a bit string to a decimal value.
- * This is merely a wrapper for the 'stoi' function.
+ * This is merely a wrapper for 'Utils::ParseBinary', which does
+ * not copy the string as 'stoi' does. A string that is not bits
+ * gives zero.
  *
  * Parameters:
  *   thebits - the ASCII array of "bits" to be converted
@@ -29,11 +35,8 @@ int Globals::BitStringToDec(const string thebits) const {
   Utils::log_stream << "enter BitStringToDec\n"; 
 #endif
 
-  // Remember that the second parameter is for positioning the pointer
-  // after doing the conversion (so we don't care here) and the third
-  // says we are converting from a string of digits in binary.
-  int stoivalue = std::stoi(thebits, nullptr, 2);
- 
+  int stoivalue = Utils::ParseBinary(thebits).value;
+
 #ifdef EBUG
   Utils::log_stream << "leave BitStringToDec\n"; 
 #endif
@@ -45,11 +48,12 @@ int Globals::BitStringToDec(const string thebits) const {
  * Function 'DecToBitString'.
  * This function converts a decimal 'int' to a string of 0s and 1s.
  *
- * We only allow conversion to a string of length 12 or of length 16
- * because we only allow an address (lessequal 4096 = 2^12) or a hex
- * operand of 16 bits.
+ * We only allow conversion to a string of length 8, 12, or 16
+ * because we only allow a character, an address (lessequal 4096 = 2^12),
+ * or a hex operand of 16 bits.
  *
- * This is basically just a wrapper for the 'bitset' function.
+ * This is the version that returns a 'string'; the work is done by the
+ * version that writes into a buffer.
  *
  * Parameters:
  *   value - the value to convert
@@ -59,29 +63,41 @@ int Globals::BitStringToDec(const string thebits) const {
  *   the 'string' of bits obtained from the 'value' parameter
 **/
 string Globals::DecToBitString(const int value, const int how_many_bits) const {
+  char buffer[Utils::kFormatBufferSize];
+  return string(this->DecToBitString(value, how_many_bits, buffer));
+}
+
+/******************************************************************************
+ * Function 'DecToBitString'.
+ * The same conversion, written into the caller's buffer so that nothing
+ * is allocated. The text is exactly that of 'std::bitset::to_string'.
+ *
+ * Parameters:
+ *   value - the value to convert
+ *   how_many_bits - the length of the result
+ *   buffer - where to put the bits, at least 'Utils::kFormatBufferSize'
+ *
+ * Returns:
+ *   'buffer', holding the null terminated bits of 'value'
+**/
+const char* Globals::DecToBitString(const int value, const int how_many_bits,
+                                    char* buffer) const {
 #ifdef EBUG
   Utils::log_stream << "enter DecToBitString\n";
 #endif
 
-  string bitsetvalue = "";
-  if (how_many_bits == 12) {
-    bitsetvalue = std::bitset<12>(value).to_string();
-  }
-  else if (how_many_bits == 16) {
-    bitsetvalue = std::bitset<16>(value).to_string();
-  }else if(how_many_bits == 8){
-    bitsetvalue = std::bitset<8>(value).to_string();
+  if ((how_many_bits == 8) || (how_many_bits == 12) ||
+      (how_many_bits == 16)) {
+    Utils::BitsInto(buffer, value, how_many_bits);
   } else {
     Utils::log_stream << "ERROR DECTOBITSTRING " << value << " "
                       << how_many_bits << endl;
     exit(0);
   }
 
-
-
 #ifdef EBUG
   Utils::log_stream << "leave DecToBitString\n";
 #endif
 
-  return bitsetvalue;
+  return buffer;
 }
@@ -24,8 +24,35 @@ class Globals {
   public:
     static const int kMaxMemory = 4096;
 
+    // The instructions by mnemonic, with the three kinds of opcode 7
+    // apart and the illegal ones last.
+    static const int kBAN = 0;
+    static const int kBR = 6;
+    static const int kRD = 7;
+    static const int kWRT = 9;
+    static const int kIllegal = 10;
+    static const int kHowManyMnemonics = 11;
+    static const char* kMnemonicNames[];
+
+    /**************************************************************************
+     * Function 'MnemonicIndex'.
+     * Which instruction the 'word' is, from 'kBAN' up to 'kIllegal'. For
+     * opcodes 0 through 6 this is the opcode itself.
+    **/
+    static int MnemonicIndex(int word) {
+      int opcode = (word >> 13) & 7;
+      if (opcode == 7) {
+        int target = word & 4095;
+        opcode = ((target >= 1) && (target <= 3)) ? kRD - 1 + target
+                                                  : kIllegal;
+      }
+      return opcode;
+    }
+
     int BitStringToDec(const string thebits) const;
     string DecToBitString(const int value, const int how_many_bits) const;
+    const char* DecToBitString(const int value, const int how_many_bits,
+                               char* buffer) const;
 
   private:
 };
@@ -119,6 +119,23 @@ void Hex::Init(string text, Globals globals) {
   this->ParseHexOperand();
 }
 
+/******************************************************************************
+ * Function 'HexDigitValue'.
+ * Looks up one uppercase hex digit without building a string of digits,
+ * so that an 'RD' needs no heap.
+ *
+ * Returns:
+ *   the value of the digit, or -1 if it isn't one
+**/
+static int HexDigitValue(char digit) {
+  if ((digit >= '0') && (digit <= '9')) {
+    return digit - '0';
+  } else if ((digit >= 'A') && (digit <= 'F')) {
+    return digit - 'A' + 10;
+  }
+  return -1;
+}
+
 /******************************************************************************
  * Function 'ParseHexOperand'.
  * Parses the text into a decimal value and sets the error flag.
@@ -132,13 +149,11 @@ void Hex::ParseHexOperand() {
   Utils::log_stream << "enter ParseHexOperand" << endl;
 #endif
 
-  string hexdigits = "0123456789ABCDEF";
-
   is_invalid_ = false;
 
   // All blanks is legal, but if any non-blank, the text must be
   // 5 characters long, and legal characters. We check for legal by
-  // a lookup in a string and then test later for invalid.
+  // looking each digit up and then test later for invalid.
   // We set the value to zero for invalid input.
   if (text_.length() != 5) {
     value_ = 0;
@@ -149,18 +164,17 @@ void Hex::ParseHexOperand() {
     // This is clumsy but functional.
     char char0 = text_.at(0);
     char char1 = text_.at(1);
-    int value1 = hexdigits.find(char1);
+    int value1 = HexDigitValue(char1);
     char char2 = text_.at(2);
-    int value2 = hexdigits.find(char2);
+    int value2 = HexDigitValue(char2);
     char char3 = text_.at(3);
-    int value3 = hexdigits.find(char3);
+    int value3 = HexDigitValue(char3);
     char char4 = text_.at(4);
-    int value4 = hexdigits.find(char4);
+    int value4 = HexDigitValue(char4);
 
     // If any of the characters weren't in the lookup we have an error.
     // Otherwise, we can build the decimal equiv of the hex. 
-    if ((value1 == string::npos) || (value2 == string::npos) ||
-        (value3 == string::npos) || (value4 == string::npos)) {
+    if ((value1 < 0) || (value2 < 0) || (value3 < 0) || (value4 < 0)) {
       value_ = 0;
       is_invalid_ = true;
     } else {
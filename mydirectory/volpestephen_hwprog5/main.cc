@@ -8,10 +8,94 @@
  * Date: 1 November 2017
  *
  * NOTE that none of the input parameters have file extensions.
+ * A data file name of '-' means the standard input, so that the
+ * data for RD can come down a pipe from another program.
  *
 **/
 
 static const string kTag = "Main: ";
+static string timing_filename = "";
+static const string kUsage = "[--trace=level] [--max-instructions=n] "
+                             "[--cores=k [--quantum=q] "
+                             "[--schedule=roundrobin|free]] "
+                             "[--debug[=interval]] "
+                             "[--record-input=replayfile] "
+                             "[--flight-recorder[=n]] [--log-thread] "
+                             "[--profile=reportfile] "
+                             "[--folded-stacks=stackfile] "
+                             "[--cost-report=runsfile "
+                             "[--cost-table=tablefile]] "
+                             "[--cache-report=reportfile "
+                             "[--cache=capacity,linesize,ways]] "
+                             "[--timing[=reportfile] "
+                             "[--timing-clock=monotonic|tsc]] "
+                             "[--perf-counters] [--count-allocations] "
+                             "[--check-allocations] "
+                             "[--binary-trace=tracefile "
+                             "[--trace-compression=none|delta|block]] "
+                             "execfilename datafilename "
+                             "outfilename logfilename\n"
+                             "       or [--trace=level] "
+                             "[--max-instructions=n] "
+                             "--replay=replayfile "
+                             "execfilename outfilename logfilename\n"
+                             "       or --decode-trace=tracefile "
+                             "logfilename decodedlogfilename\n"
+                             "       or --show-trace=tracefile [--from=i] "
+                             "[--count=n]\n"
+                             "       or --compare-costs=runsfile\n"
+                             "       or --server=socketpath [--workers=n]\n"
+                             "       or --client=socketpath";
+
+/****************************************************************
+ * Write the timing report, to the file or if there is none to
+ * standard output. This is called at exit, so that the report
+ * is written however the program ends.
+**/
+static void WriteTimingReport() {
+  if (timing_filename != "") {
+    ofstream timing_stream(timing_filename.c_str());
+    ScopedTimer::WriteReport(timing_stream);
+  } else {
+    ScopedTimer::WriteReport(cout);
+  }
+}
+
+/****************************************************************
+ * Interpret the program with the allocations counted. Without
+ * tracing, a step of the machine is meant to need no heap at all,
+ * so any allocation here is a regression. A program that faults
+ * still gets its count, but the fault message is allowed to
+ * allocate, so only a program that stops is held to zero.
+ *
+ * Parameters:
+ *   interpreter - the loaded machine
+ *   data_scanner - the input for 'RD'
+ *   out_stream - the output for 'WRT'
+ * Returns:
+ *   false if the loop allocated
+**/
+static bool CheckAllocations(Interpreter& interpreter, Scanner& data_scanner,
+                             ofstream& out_stream) {
+  bool was_counting = AllocationCounter::IsEnabled();
+  AllocationCounter::SetEnabled(true);
+  interpreter.SetExitOnFault(false);
+  AllocationCounter::Counts before = AllocationCounter::GetThreadCounts();
+  interpreter.Interpret(data_scanner, out_stream);
+  AllocationCounter::Counts after = AllocationCounter::GetThreadCounts();
+  AllocationCounter::SetEnabled(was_counting);
+
+  LONG how_many = after.allocations - before.allocations;
+  cout << kTag << how_many << " ALLOCATIONS, "
+       << (after.bytes - before.bytes) << " BYTES, IN "
+       << interpreter.GetInstructionCount() << " INSTRUCTIONS"
+       << (interpreter.IsFaulted() ? " TO A FAULT" : "") << endl;
+  if ((how_many > 0) && !interpreter.IsFaulted()) {
+    cout << kTag << "the interpreter loop allocated" << endl;
+    return false;
+  }
+  return true;
+}
 
 int main(int argc, char *argv[]) {
   string exec_filename = "dummyexecname";
@@ -26,33 +110,415 @@ int main(int argc, char *argv[]) {
 
   Interpreter interpreter;
 
-  Utils::CheckArgs(4, argc, argv, "execfilename datafilename outfilename logfilename");
-  exec_filename = static_cast<string>(argv[1]) + ".txt";
-  binary_filename = static_cast<string>(argv[1]) + ".bin";
-  data_filename = static_cast<string>(argv[2]) + ".txt";
-  out_filename = static_cast<string>(argv[3]) + ".txt";
-  log_filename = static_cast<string>(argv[4]) + ".txt";
+  // Options all begin with "--" and come before the file names.
+  string socket_path = "";
+  string client_path = "";
+  int how_many_workers = Server::kDefaultWorkers;
+  int how_many_cores = 1;
+  int quantum = 1;
+  bool deterministic = true;
+  int checkpoint_interval = 0;
+  string record_filename = "";
+  string replay_filename = "";
+  string trace_filename = "";
+  string decode_filename = "";
+  string show_filename = "";
+  string profile_filename = "";
+  string folded_filename = "";
+  string cost_table_filename = "";
+  string cost_report_filename = "";
+  string compare_filename = "";
+  string cache_geometry = "";
+  string cache_filename = "";
+  bool is_timing = false;
+  bool is_counting = false;
+  bool is_counting_allocations = false;
+  bool is_checking_allocations = false;
+  bool is_within_budget = true;
+  string timing_clock = "monotonic";
+  int trace_compression = TraceWriter::kCompressNone;
+  LONG show_from = 0;
+  LONG show_count = 1;
+  int argsub = 1;
+  while ((argsub < argc) && (string(argv[argsub]).substr(0, 2) == "--")) {
+    string option = argv[argsub];
+    string value = "";
+    if (option.find('=') != string::npos) {
+      value = option.substr(option.find('=') + 1);
+      option = option.substr(0, option.find('='));
+    }
+
+    if (option == "--server") {
+      socket_path = value;
+    } else if (option == "--client") {
+      client_path = value;
+    } else if (option == "--workers") {
+      how_many_workers = atoi(value.c_str());
+    } else if (option == "--trace") {
+      interpreter.SetTraceLevel(atoi(value.c_str()));
+    } else if (option == "--max-instructions") {
+      interpreter.SetMaxInstructions(atoi(value.c_str()));
+    } else if (option == "--debug") {
+      checkpoint_interval = (value == "") ? Debugger::kDefaultCheckpointInterval
+                                          : atoi(value.c_str());
+      if (checkpoint_interval < 1) {
+        checkpoint_interval = -1;
+      }
+    } else if (option == "--record-input") {
+      record_filename = value;
+    } else if (option == "--replay") {
+      replay_filename = value;
+    } else if (option == "--binary-trace") {
+      trace_filename = value;
+    } else if (option == "--decode-trace") {
+      decode_filename = value;
+    } else if ((option == "--trace-compression") &&
+               ((value == "none") || (value == "delta") ||
+                (value == "block"))) {
+      trace_compression = (value == "none") ? TraceWriter::kCompressNone
+                        : (value == "delta") ? TraceWriter::kCompressDelta
+                                             : TraceWriter::kCompressBlock;
+    } else if (option == "--show-trace") {
+      show_filename = value;
+    } else if (option == "--from") {
+      show_from = atoll(value.c_str());
+    } else if (option == "--count") {
+      show_count = atoll(value.c_str());
+    } else if (option == "--flight-recorder") {
+      interpreter.SetFlightRecorderSize((value == "")
+                                        ? FlightRecorder::kDefaultSize
+                                        : atoi(value.c_str()));
+    } else if (option == "--profile") {
+      profile_filename = value;
+    } else if (option == "--folded-stacks") {
+      folded_filename = value;
+    } else if (option == "--cost-table") {
+      cost_table_filename = value;
+    } else if (option == "--cost-report") {
+      cost_report_filename = value;
+    } else if (option == "--compare-costs") {
+      compare_filename = value;
+    } else if (option == "--cache") {
+      cache_geometry = value;
+    } else if (option == "--cache-report") {
+      cache_filename = value;
+    } else if (option == "--timing") {
+      is_timing = true;
+      timing_filename = value;
+    } else if (option == "--perf-counters") {
+      is_timing = true;
+      is_counting = true;
+    } else if (option == "--count-allocations") {
+      is_timing = true;
+      is_counting_allocations = true;
+    } else if (option == "--check-allocations") {
+      is_checking_allocations = true;
+    } else if ((option == "--timing-clock") &&
+               ((value == "monotonic") || (value == "tsc"))) {
+      timing_clock = value;
+    } else if (option == "--log-thread") {
+      Utils::log_stream.StartWriterThread();
+    } else if (option == "--cores") {
+      how_many_cores = atoi(value.c_str());
+    } else if (option == "--quantum") {
+      quantum = atoi(value.c_str());
+    } else if ((option == "--schedule") &&
+               ((value == "roundrobin") || (value == "free"))) {
+      deterministic = (value == "roundrobin");
+    } else {
+      cout << kTag << "unknown option '" << option << "'" << endl;
+      cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+      exit(1);
+    }
+    ++argsub;
+  }
+
+  if (checkpoint_interval < 0) {
+    cout << kTag << "--debug needs an interval of at least 1" << endl;
+    cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+    exit(1);
+  }
+
+  if ((how_many_cores < 1) || (quantum < 1)) {
+    cout << kTag << "--cores and --quantum must be at least 1" << endl;
+    cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+    exit(1);
+  }
+
+  if (how_many_workers < 1) {
+    cout << kTag << "--workers must be at least 1" << endl;
+    cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+    exit(1);
+  }
+
+  if (client_path != "") {
+    return Server::RunClient(client_path, cin, cout);
+  }
+
+  if (socket_path != "") {
+    Server server;
+    return server.Run(socket_path, how_many_workers);
+  }
 
-  Utils::LogFileOpen(log_filename);
-  exec_scanner.OpenFile(exec_filename);
-  data_scanner.OpenFile(data_filename);
-  Utils::FileOpen(out_stream, out_filename);
+  if (show_filename != "") {
+    TraceDecoder decoder;
+    if (!decoder.Show(show_filename, show_from, show_count, cout)) {
+      cout << kTag << "unable to read trace '" << show_filename << "'"
+           << endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  if (compare_filename != "") {
+    if (!CostModel::WriteComparison(compare_filename, cout)) {
+      cout << kTag << "unable to read runs '" << compare_filename << "'"
+           << endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  CostModel cost_model;
+  if ((cost_table_filename != "") &&
+      !cost_model.LoadTable(cost_table_filename)) {
+    cout << kTag << "unable to read cost table '" << cost_table_filename
+         << "'" << endl;
+    cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+    exit(1);
+  }
+
+  Cache cache;
+  if ((cache_geometry != "") && !cache.Configure(cache_geometry)) {
+    cout << kTag << "bad cache geometry '" << cache_geometry << "'" << endl;
+    cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+    exit(1);
+  }
+
+  // Shift the file names down so they are where 'CheckArgs' expects them.
+  argv[argsub - 1] = argv[0];
+  argc -= argsub - 1;
+  argv += argsub - 1;
+
+  if (decode_filename != "") {
+    Utils::CheckArgs(2, argc, argv, kUsage);
+    TraceDecoder decoder;
+    if (!decoder.Decode(decode_filename,
+                        static_cast<string>(argv[1]) + ".txt",
+                        static_cast<string>(argv[2]) + ".txt")) {
+      cout << kTag << "unable to decode trace '" << decode_filename << "'"
+           << endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  // The binary trace is of a run straight through. The records of the
+  // cores of '--cores' are numbered in the order the cores ran them.
+  if ((trace_filename != "") && (checkpoint_interval > 0)) {
+    cout << kTag << "--binary-trace can't be used with --debug" << endl;
+    cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+    exit(1);
+  }
+
+  // The debugger, the recording, and the replay are of one machine.
+  if ((how_many_cores > 1) &&
+      ((checkpoint_interval > 0) || (record_filename != "") ||
+       (replay_filename != ""))) {
+    cout << kTag << "--cores can't be used with --debug, --record-input, "
+         << "or --replay" << endl;
+    cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+    exit(1);
+  }
+
+  // The allocation check is of the plain loop of one machine, so it runs
+  // with the trace off.
+  if (is_checking_allocations &&
+      ((how_many_cores > 1) || (checkpoint_interval > 0) ||
+       (trace_filename != ""))) {
+    cout << kTag << "--check-allocations can't be used with --cores, "
+         << "--debug, or --binary-trace" << endl;
+    cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+    exit(1);
+  }
+  if (is_checking_allocations) {
+    interpreter.SetTraceLevel(Interpreter::kTraceNone);
+  }
+
+  // A replay takes its input from the replay file, so there is no data file.
+  if (replay_filename != "") {
+    Utils::CheckArgs(3, argc, argv, kUsage);
+    exec_filename = static_cast<string>(argv[1]) + ".txt";
+    binary_filename = static_cast<string>(argv[1]) + ".bin";
+    out_filename = static_cast<string>(argv[2]) + ".txt";
+    log_filename = static_cast<string>(argv[3]) + ".txt";
+  } else {
+    Utils::CheckArgs(4, argc, argv, kUsage);
+    exec_filename = static_cast<string>(argv[1]) + ".txt";
+    binary_filename = static_cast<string>(argv[1]) + ".bin";
+    data_filename = (static_cast<string>(argv[2]) == "-")
+                  ? "-" : static_cast<string>(argv[2]) + ".txt";
+    out_filename = static_cast<string>(argv[3]) + ".txt";
+    log_filename = static_cast<string>(argv[4]) + ".txt";
+  }
+
+  // The timing report is written at exit, however the program ends. The
+  // counters are what 'perf_event_open' will give us, maybe none.
+  if (is_timing) {
+    if ((timing_clock == "tsc") &&
+        !ScopedTimer::SetClock(ScopedTimer::kClockTSC)) {
+      cout << kTag << "no invariant TSC, timing with the monotonic clock"
+           << endl;
+    }
+    ScopedTimer::SetEnabled(true);
+    AllocationCounter::SetEnabled(is_counting_allocations);
+    if (is_counting && !ScopedTimer::SetCounting(true)) {
+      cout << kTag << "no performance counters, "
+           << ScopedTimer::GetCountingError() << ", timing only" << endl;
+    }
+    atexit(WriteTimingReport);
+  }
+
+  {
+    ScopedTimer timer("open files");
+    Utils::LogFileOpen(log_filename);
+    exec_scanner.OpenFile(exec_filename);
+    if (data_filename == "-") {
+      data_scanner.OpenDescriptor(0);
+    } else if (replay_filename == "") {
+      data_scanner.OpenFile(data_filename);
+    }
+    Utils::FileOpen(out_stream, out_filename);
+  }
 
   Utils::log_stream << kTag << "Beginning execution" << endl;
   Utils::log_stream.flush();
 
   Utils::log_stream << kTag << "logfile '" << log_filename << "'" << endl;
 
-  interpreter.Load(exec_scanner, binary_filename);
-  exec_scanner.Close();
-  interpreter.Interpret(data_scanner, out_stream);
+  {
+    ScopedTimer timer("load");
+    interpreter.Load(exec_scanner, binary_filename);
+    exec_scanner.Close();
+  }
+
+  // The instruction text now comes from decoding the binary trace, so the
+  // text trace is turned off. The decoded text goes where the log is now.
+  TraceWriter trace_writer;
+  trace_writer.SetCompression(trace_compression);
+  if (trace_filename != "") {
+    vector<int> image;
+    for (int address = 0; address < interpreter.GetMemorySize(); ++address) {
+      image.push_back(interpreter.GetMemoryWord(address));
+    }
+    if (!trace_writer.Open(trace_filename, interpreter.GetTraceLevel(),
+                           Utils::log_stream.tellp(), image)) {
+      Utils::log_stream << kTag << "unable to write trace file '"
+                        << trace_filename << "'" << endl;
+      exit(1);
+    }
+    interpreter.SetTraceLevel(Interpreter::kTraceNone);
+    interpreter.SetTraceWriter(&trace_writer);
+  }
+
+  // The profile, the costs, and the cache report are written even if the
+  // program crashes, and then we finish just as the crash would have.
+  Profiler profiler;
+  bool is_profiling = (profile_filename != "") || (folded_filename != "");
+  if (is_profiling) {
+    interpreter.SetExitOnFault(false);
+    interpreter.SetProfiler(&profiler);
+  }
+  if (cost_report_filename != "") {
+    interpreter.SetExitOnFault(false);
+    interpreter.SetCostModel(&cost_model);
+  }
+  if (cache_filename != "") {
+    interpreter.SetExitOnFault(false);
+    interpreter.SetCache(&cache);
+  }
+
+  if (checkpoint_interval > 0) {
+    interpreter.SetExitOnFault(false);
+    interpreter.StartRecording(checkpoint_interval);
+    interpreter.Interpret(data_scanner, out_stream);
+    Debugger debugger;
+    debugger.Run(interpreter, cin, cout);
+  } else if (replay_filename != "") {
+    if (!interpreter.LoadInputLog(replay_filename)) {
+      Utils::log_stream << kTag << "replay file '" << replay_filename
+                        << "' is unreadable or is for another program" << endl;
+      exit(1);
+    }
+    interpreter.Interpret(data_scanner, out_stream);
+  } else if (record_filename != "") {
+    // Save the input even if the program crashes, then finish as usual.
+    interpreter.SetExitOnFault(false);
+    interpreter.StartRecording(0);
+    interpreter.Interpret(data_scanner, out_stream);
+    if (!interpreter.SaveInputLog(record_filename)) {
+      Utils::log_stream << kTag << "unable to write replay file '"
+                        << record_filename << "'" << endl;
+    }
+    if (interpreter.IsFaulted()) {
+      exit(0);
+    }
+  } else if (how_many_cores > 1) {
+    interpreter.InterpretCores(data_scanner, out_stream, how_many_cores,
+                               quantum, deterministic);
+  } else if (is_checking_allocations) {
+    is_within_budget = CheckAllocations(interpreter, data_scanner,
+                                        out_stream);
+  } else {
+    interpreter.Interpret(data_scanner, out_stream);
+  }
+
+  {
+    ScopedTimer timer("reports");
+    trace_writer.Close();
+
+    string program_name = static_cast<string>(argv[1]);
+    program_name = program_name.substr(program_name.find_last_of('/') + 1);
+    if (is_profiling) {
+      interpreter.SetProfiler(NULL);
+      if (profile_filename != "") {
+        ofstream profile_stream(profile_filename.c_str());
+        profiler.WriteReport(profile_stream);
+      }
+      if (folded_filename != "") {
+        ofstream folded_stream(folded_filename.c_str());
+        profiler.WriteFoldedStacks(folded_stream, program_name);
+      }
+    }
+    if (cost_report_filename != "") {
+      interpreter.SetCostModel(NULL);
+      string data_name = (replay_filename != "")
+                       ? replay_filename : static_cast<string>(argv[2]);
+      data_name = data_name.substr(data_name.find_last_of('/') + 1);
+      ofstream cost_stream(cost_report_filename.c_str(), ios::app);
+      cost_model.WriteRun(cost_stream, program_name, data_name);
+    }
+    if (cache_filename != "") {
+      interpreter.SetCache(NULL);
+      ofstream cache_stream(cache_filename.c_str());
+      cache.WriteReport(cache_stream);
+    }
+    if ((is_profiling || (cost_report_filename != "") ||
+         (cache_filename != "") || is_checking_allocations) &&
+        interpreter.IsFaulted() && (checkpoint_interval == 0)) {
+      exit(0);
+    }
+  }
 
   Utils::log_stream << kTag << "Ending execution" << endl;
   Utils::log_stream.flush();
 
-  Utils::FileClose(out_stream);
-  Utils::FileClose(Utils::log_stream);
+  {
+    ScopedTimer timer("close files");
+    Utils::FileClose(out_stream);
+    Utils::FileClose(Utils::log_stream);
+  }
 
-  return 0;
+  return is_within_budget ? 0 : 1;
 }
 
@@ -14,9 +14,18 @@
 using namespace std;
 
 #include "../../Utilities/utils.h"
+#include "../../Utilities/allocationcounter.h"
 #include "../../Utilities/scanner.h"
 #include "../../Utilities/scanline.h"
+#include "../../Utilities/scopedtimer.h"
 
+#include "pullet16cache.h"
+#include "pullet16costmodel.h"
+#include "pullet16debugger.h"
 #include "pullet16interpreter.h"
+#include "pullet16profiler.h"
+#include "pullet16server.h"
+#include "pullet16trace.h"
+#include "pullet16tracedecoder.h"
 
 #endif // MAIN_H
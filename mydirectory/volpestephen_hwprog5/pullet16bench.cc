@@ -0,0 +1,407 @@
+/****************************************************************
+ * Benchmark of the Pullet16 interpreter loop.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+ * Usage: pullet16bench [--instructions=n] [--runs=r] [--csv=file]
+ *                      [--label=name]
+ *                      [--program=execfilename --data=datafilename]
+ *
+ * We run a fixed corpus of programs, each written out as an
+ * executable the way the assembler writes one, and loaded and
+ * interpreted just as 'Aprog' does:
+ *   tight       - ADD, SUB, AND, and branches on direct addresses
+ *   indirect    - every operand and the branch back go through a
+ *                 pointer
+ *   readwrite   - RD and WRT and a branch back, on a data file
+ *                 big enough never to run out
+ *   selfmodify  - a loop that rewrites the target of one of its
+ *                 own loads every time around
+ * None of them stop, so each runs until it times out at the
+ * instruction count we set. With '--program' we run that one
+ * executable and its data instead, named without extensions as
+ * for 'Aprog', as from 'pullet16gen', so that the size and the
+ * length of the run can be scaled. It runs until it stops or
+ * times out.
+ *
+ * Each program is run at each trace level, with 'n' instructions
+ * at level 0 and a tenth as many for each level up, since the
+ * trace costs so much more. A run is done in a child process, so
+ * that its peak resident size is its own, and of 'r' runs we keep
+ * the fastest. The log, the output, and the standard output of the
+ * child all go to '/dev/null', so what is timed is the formatting
+ * of the trace and not the disk.
+ *
+ * The results are a table on the standard output and, with
+ * '--csv', lines added to the end of the file with 'name' as their
+ * label, so a file can track the numbers from one commit to the
+ * next.
+**/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../Utilities/scanner.h"
+#include "../../Utilities/utils.h"
+
+#include "pullet16generator.h"
+#include "pullet16interpreter.h"
+
+static const string kTag = "BENCH: ";
+static const int kHowManyTraceLevels = 3;
+
+/****************************************************************
+ * One program of the corpus, how many data values it needs for
+ * each instruction it executes, and its files.
+**/
+struct Workload {
+  string name;
+  vector<int> words;
+  double reads_per_instruction;
+  string basename;
+  string data_filename;
+};
+
+/****************************************************************
+ * What the child reports of one run.
+**/
+struct Measurement {
+  LONG instructions;
+  double seconds;
+  bool is_faulted;
+};
+
+/****************************************************************
+ * Function 'Word', the machine word for an opcode, an indirect bit,
+ * and a target.
+**/
+static int Word(int opcode, int indirect, int target) {
+  return (opcode << 13) | (indirect << 12) | target;
+}
+
+/****************************************************************
+ * Function 'MakeCorpus'.
+ *
+ * Returns:
+ *   the programs to run
+**/
+static vector<Workload> MakeCorpus() {
+  const int kBAN = 0, kSUB = 1, kSTC = 2, kAND = 3, kADD = 4, kLD = 5,
+            kBR = 6, kIO = 7;
+  const int kRD = 1, kWRT = 3;
+  vector<Workload> corpus;
+
+  Workload tight;
+  tight.name = "tight";
+  tight.words = { Word(kADD, 0, 5), Word(kSUB, 0, 6), Word(kAND, 0, 7),
+                  Word(kBAN, 0, 0), Word(kBR, 0, 0),
+                  3, 1, 0x7FFF };
+  tight.reads_per_instruction = 0.0;
+  corpus.push_back(tight);
+
+  Workload indirect;
+  indirect.name = "indirect";
+  indirect.words = { Word(kLD, 1, 8), Word(kADD, 1, 9), Word(kSTC, 1, 10),
+                     Word(kBR, 1, 11), 0, 0, 0, 0,
+                     12, 13, 14, 0,
+                     5, 7, 0 };
+  indirect.reads_per_instruction = 0.0;
+  corpus.push_back(indirect);
+
+  Workload readwrite;
+  readwrite.name = "readwrite";
+  readwrite.words = { Word(kIO, 0, kRD), Word(kIO, 0, kWRT),
+                      Word(kBR, 0, 0) };
+  readwrite.reads_per_instruction = 1.0 / 3.0;
+  corpus.push_back(readwrite);
+
+  // The load at 4 walks its target through the first 1024 words; the
+  // mask keeps the opcode and clears the indirect bit.
+  Workload selfmodify;
+  selfmodify.name = "selfmodify";
+  selfmodify.words = { Word(kLD, 0, 4), Word(kADD, 0, 7), Word(kAND, 0, 8),
+                       Word(kSTC, 0, 4), Word(kLD, 0, 16), Word(kBR, 0, 0),
+                       0, 1, 0xA3FF };
+  selfmodify.reads_per_instruction = 0.0;
+  corpus.push_back(selfmodify);
+
+  return corpus;
+}
+
+/****************************************************************
+ * Function 'WriteData', to write 'how_many' values for RD.
+ *
+ * Returns:
+ *   false if the file can't be written
+**/
+static bool WriteData(LONG how_many, string filename) {
+  FILE* data_file = fopen(filename.c_str(), "w");
+  if (NULL == data_file) {
+    return false;
+  }
+  for (LONG sub = 0; sub < how_many; ++sub) {
+    int value = static_cast<int>((sub * 2654435761LL) % 0x8000);
+    fprintf(data_file, "%c%04X\n", (sub & 1) ? '-' : '+', value);
+  }
+  return 0 == fclose(data_file);
+}
+
+/****************************************************************
+ * Function 'RunChild', the body of the child process for a run.
+ * It loads the program, interprets it, and writes what it
+ * measured down 'result_descriptor'.
+**/
+static void RunChild(string basename, string data_filename, int trace_level,
+                     LONG instructions, int result_descriptor) {
+  int null_descriptor = open("/dev/null", O_WRONLY);
+  dup2(null_descriptor, 1);
+  close(null_descriptor);
+
+  Utils::LogFileOpen("/dev/null");
+  ofstream out_stream("/dev/null");
+  Scanner exec_scanner;
+  Scanner data_scanner;
+  exec_scanner.OpenFile(basename + ".txt");
+  data_scanner.OpenFile(data_filename);
+
+  Interpreter interpreter;
+  interpreter.SetExitOnFault(false);
+  interpreter.SetTraceLevel(trace_level);
+  interpreter.SetMaxInstructions(static_cast<int>(instructions));
+  interpreter.Load(exec_scanner, basename + ".bin");
+  exec_scanner.Close();
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  interpreter.Interpret(data_scanner, out_stream);
+  Measurement measurement;
+  measurement.seconds = chrono::duration<double>(
+      chrono::steady_clock::now() - start).count();
+  measurement.instructions = interpreter.GetInstructionCount();
+  measurement.is_faulted = interpreter.IsFaulted();
+
+  Utils::log_stream.flush();
+  ssize_t how_many_bytes = write(result_descriptor, &measurement,
+                                 sizeof(measurement));
+  _exit((how_many_bytes == sizeof(measurement)) ? 0 : 1);
+}
+
+/****************************************************************
+ * Function 'RunOnce', to run a program in a child process.
+ *
+ * Parameters:
+ *   measurement - what the child measured
+ *   peak_kilobytes - the peak resident size of the child
+ * Returns:
+ *   false if the child failed
+**/
+static bool RunOnce(string basename, string data_filename, int trace_level,
+                    LONG instructions, Measurement& measurement,
+                    LONG& peak_kilobytes) {
+  int descriptors[2];
+  if (pipe(descriptors) < 0) {
+    return false;
+  }
+  cout.flush();
+  pid_t child = fork();
+  if (child < 0) {
+    close(descriptors[0]);
+    close(descriptors[1]);
+    return false;
+  }
+  if (0 == child) {
+    close(descriptors[0]);
+    RunChild(basename, data_filename, trace_level, instructions,
+             descriptors[1]);
+  }
+
+  close(descriptors[1]);
+  ssize_t how_many_bytes = read(descriptors[0], &measurement,
+                                sizeof(measurement));
+  close(descriptors[0]);
+  int status = 0;
+  struct rusage usage;
+  if (wait4(child, &status, 0, &usage) < 0) {
+    return false;
+  }
+  peak_kilobytes = usage.ru_maxrss;
+  return (how_many_bytes == sizeof(measurement)) && WIFEXITED(status) &&
+         (0 == WEXITSTATUS(status));
+}
+
+int main(int argc, char *argv[]) {
+  LONG instructions = 2000000;
+  int how_many_runs = 3;
+  string csv_filename = "";
+  string label = "";
+  string program_basename = "";
+  string program_data_filename = "";
+  for (int argsub = 1; argsub < argc; ++argsub) {
+    string option = argv[argsub];
+    string value = "";
+    if (option.find('=') != string::npos) {
+      value = option.substr(option.find('=') + 1);
+      option = option.substr(0, option.find('='));
+    }
+    if (option == "--instructions") {
+      instructions = atoll(value.c_str());
+    } else if (option == "--runs") {
+      how_many_runs = atoi(value.c_str());
+    } else if (option == "--csv") {
+      csv_filename = value;
+    } else if (option == "--label") {
+      label = value;
+    } else if (option == "--program") {
+      program_basename = value;
+    } else if (option == "--data") {
+      program_data_filename = value + ".txt";
+    } else {
+      cout << kTag << "usage: " << argv[0] << " [--instructions=n] "
+           << "[--runs=r] [--csv=file] [--label=name] "
+           << "[--program=execfilename --data=datafilename]" << endl;
+      return 1;
+    }
+  }
+  if ((program_basename == "") != (program_data_filename == "")) {
+    cout << kTag << "--program and --data go together" << endl;
+    return 1;
+  }
+  if ((instructions < 1) || (instructions > 2000000000) ||
+      (how_many_runs < 1)) {
+    cout << kTag << "the counts must be positive and fit in an int" << endl;
+    return 1;
+  }
+
+  // The CSV file gets its header only when it is new.
+  ofstream csv_stream;
+  if (csv_filename != "") {
+    bool is_new = (access(csv_filename.c_str(), F_OK) != 0);
+    csv_stream.open(csv_filename.c_str(), ios::app);
+    if (!csv_stream) {
+      cout << kTag << "unable to write '" << csv_filename << "'" << endl;
+      return 1;
+    }
+    if (is_new) {
+      csv_stream << "label,workload,trace_level,instructions,seconds,"
+                 << "instructions_per_second,ns_per_instruction,"
+                 << "peak_rss_kb" << endl;
+    }
+  }
+
+  // A program of our own is named from where we are now, before we
+  // move to the work directory.
+  vector<Workload> corpus;
+  if (program_basename != "") {
+    char current[4096];
+    string prefix = (NULL != getcwd(current, sizeof(current)))
+                  ? static_cast<string>(current) + "/" : "";
+    Workload program;
+    program.name = program_basename.substr(
+        program_basename.find_last_of('/') + 1);
+    program.reads_per_instruction = 0.0;
+    program.basename = (program_basename[0] == '/')
+                     ? program_basename : prefix + program_basename;
+    program.data_filename = (program_data_filename[0] == '/')
+                          ? program_data_filename
+                          : prefix + program_data_filename;
+    corpus.push_back(program);
+  }
+
+  // The programs, their data, and the 'test.bin' that 'Load' writes
+  // all go in a directory of our own, which we remove at the end.
+  char directory[] = "/tmp/pullet16benchXXXXXX";
+  if ((NULL == mkdtemp(directory)) || (chdir(directory) < 0)) {
+    cout << kTag << "unable to make a work directory" << endl;
+    return 1;
+  }
+  vector<string> filenames;
+  filenames.push_back("test.bin");
+  if (corpus.empty()) {
+    corpus = MakeCorpus();
+    for (auto iter = corpus.begin(); iter != corpus.end(); ++iter) {
+      iter->basename = iter->name;
+      iter->data_filename = iter->name + "data.txt";
+      filenames.push_back(iter->basename + ".txt");
+      filenames.push_back(iter->basename + ".bin");
+      filenames.push_back(iter->data_filename);
+      LONG how_many_values = static_cast<LONG>(
+          iter->reads_per_instruction * instructions) + 1;
+      if (!Generator::WriteExecutable(iter->words, iter->basename) ||
+          !WriteData(how_many_values, iter->data_filename)) {
+        cout << kTag << "unable to write the program '" << iter->name << "'"
+             << endl;
+        return 1;
+      }
+    }
+  }
+
+  cout << "WORKLOAD    TRACE  INSTRUCTIONS     MINSTR/S   NS/INSTR"
+       << "  PEAK RSS KB" << endl;
+  bool is_ok = true;
+  for (auto iter = corpus.begin(); iter != corpus.end(); ++iter) {
+    string name = iter->name;
+    LONG level_instructions = instructions;
+    for (int level = 0; level < kHowManyTraceLevels; ++level) {
+      Measurement best = { 0, -1.0, false };
+      LONG peak_kilobytes = 0;
+      for (int run = 0; run < how_many_runs; ++run) {
+        Measurement measurement;
+        LONG run_kilobytes = 0;
+        if (!RunOnce(iter->basename, iter->data_filename, level,
+                     level_instructions, measurement, run_kilobytes) ||
+            measurement.is_faulted) {
+          cout << kTag << "'" << name << "' failed at trace level "
+               << level << endl;
+          is_ok = false;
+          break;
+        }
+        if ((best.seconds < 0.0) || (measurement.seconds < best.seconds)) {
+          best = measurement;
+        }
+        peak_kilobytes = max(peak_kilobytes, run_kilobytes);
+      }
+
+      if (best.seconds >= 0.0) {
+        double per_second = (best.seconds > 0.0)
+                          ? best.instructions / best.seconds : 0.0;
+        double nanoseconds = (best.instructions > 0)
+                           ? 1.0e9 * best.seconds / best.instructions : 0.0;
+        char line[160];
+        snprintf(line, sizeof(line), "%-10s %6d %13lld %12.3f %10.1f %12lld",
+                 name.c_str(), level,
+                 static_cast<long long>(best.instructions),
+                 per_second / 1.0e6, nanoseconds,
+                 static_cast<long long>(peak_kilobytes));
+        cout << line << endl;
+        if (csv_stream.is_open()) {
+          snprintf(line, sizeof(line), "%s,%d,%lld,%.6f,%.0f,%.2f,%lld",
+                   name.c_str(), level,
+                   static_cast<long long>(best.instructions), best.seconds,
+                   per_second, nanoseconds,
+                   static_cast<long long>(peak_kilobytes));
+          csv_stream << label << "," << line << endl;
+        }
+      }
+      level_instructions = max(level_instructions / 10,
+                               static_cast<LONG>(1));
+    }
+  }
+
+  for (auto iter = filenames.begin(); iter != filenames.end(); ++iter) {
+    unlink(iter->c_str());
+  }
+  if (chdir("/") == 0) {
+    rmdir(directory);
+  }
+  return is_ok ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+#include "pullet16cache.h"
+
+#include "pullet16interpreter.h"
+
+/******************************************************************************
+ *3456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
+ * Class 'Cache' for simulating a memory cache in front of a Pullet16.
+ *
+ * The interpreter tells the cache about every word it fetches, reads, and
+ * writes: the instruction fetch, the word read for an indirect address,
+ * the operand of LD, ADD, SUB, and AND, and the word written by STC. The
+ * cache does not hold any values, only which lines of memory it would
+ * have, so it changes nothing about the run and can be left on for a run
+ * of millions of instructions.
+ *
+ * The cache is set associative, with
+ *   a capacity in words
+ *   a line size in words, the unit that is brought in on a miss
+ *   a number of ways, the lines each set can hold
+ * and the number of sets is the capacity over the line size times the
+ * ways, so one way is a direct mapped cache and one set is fully
+ * associative. A set drops its least recently used line to make room.
+ * Writes allocate a line like reads, and a line that has been written is
+ * counted as written back when it is dropped.
+ *
+ * The report gives the hits and misses by kind of access and then, for
+ * every PC that missed, the misses on fetching the instruction and on
+ * the data it read or wrote, with the PCs that missed most first.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+/******************************************************************************
+ * Constructor
+**/
+Cache::Cache() {
+  ostringstream geometry;
+  geometry << kDefaultCapacity << "," << kDefaultLineSize << ","
+           << kDefaultWays;
+  this->Configure(geometry.str());
+}
+
+/******************************************************************************
+ * Destructor
+**/
+Cache::~Cache() {
+}
+
+/******************************************************************************
+ * Accessors and Mutators
+**/
+
+/******************************************************************************
+ * Accessor for the total number of accesses.
+**/
+LONG Cache::GetAccesses() const {
+  LONG total = 0;
+  for (auto iter = counts_.begin(); iter != counts_.end(); ++iter) {
+    total += *iter;
+  }
+  return total;
+}
+
+/******************************************************************************
+ * Accessor for the total number of misses.
+**/
+LONG Cache::GetMisses() const {
+  LONG total = 0;
+  for (auto iter = misses_.begin(); iter != misses_.end(); ++iter) {
+    total += *iter;
+  }
+  return total;
+}
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'Clear'.
+ * Empty the cache and set all the counts back to zero.
+**/
+void Cache::Clear() {
+  entries_.assign(how_many_sets_ * how_many_ways_, -1);
+  counts_.assign(kHowManyKinds, 0);
+  misses_.assign(kHowManyKinds, 0);
+  writebacks_ = 0;
+  words_.assign(Globals::kMaxMemory, 0);
+  fetch_counts_.assign(Globals::kMaxMemory, 0);
+  fetch_misses_.assign(Globals::kMaxMemory, 0);
+  data_counts_.assign(Globals::kMaxMemory, 0);
+  data_misses_.assign(Globals::kMaxMemory, 0);
+}
+
+/******************************************************************************
+ * Function 'Configure'.
+ * Set the shape of the cache and empty it.
+ *
+ * Parameter:
+ *   geometry - the capacity, the line size, and the number of ways, in
+ *              that order and separated by commas, as in "128,4,2"
+ *
+ * Returns:
+ *   false if the geometry makes no sense, in which case the cache is
+ *   left as it was
+**/
+bool Cache::Configure(string geometry) {
+  istringstream geometry_stream(geometry);
+  int capacity = 0;
+  int line_size = 0;
+  int how_many_ways = 0;
+  char comma1 = ' ';
+  char comma2 = ' ';
+  string extra;
+  if (!(geometry_stream >> capacity >> comma1 >> line_size >> comma2
+                        >> how_many_ways) ||
+      (geometry_stream >> extra) || (comma1 != ',') || (comma2 != ',')) {
+    return false;
+  }
+  if ((capacity <= 0) || (line_size <= 0) || (how_many_ways <= 0) ||
+      (capacity > Globals::kMaxMemory) ||
+      (capacity % (line_size * how_many_ways) != 0)) {
+    return false;
+  }
+
+  capacity_ = capacity;
+  line_size_ = line_size;
+  how_many_ways_ = how_many_ways;
+  how_many_sets_ = capacity / (line_size * how_many_ways);
+
+  address_lines_.resize(Globals::kMaxMemory);
+  address_sets_.resize(Globals::kMaxMemory);
+  for (int address = 0; address < Globals::kMaxMemory; ++address) {
+    int line = address / line_size_;
+    address_lines_[address] = line;
+    address_sets_[address] = (line % how_many_sets_) * how_many_ways_;
+  }
+
+  this->Clear();
+  return true;
+}
+
+/******************************************************************************
+ * Function 'WriteReport'.
+ * Write the hits and misses by kind of access and then by PC.
+ *
+ * Parameter:
+ *   out_stream - where to write
+**/
+void Cache::WriteReport(ostream& out_stream) const {
+  static const char* kKindNames[] = { "FETCH", "READ ", "WRITE" };
+
+  out_stream << "CACHE: " << capacity_ << " WORDS, " << line_size_
+             << "-WORD LINES, " << how_many_ways_ << "-WAY, "
+             << how_many_sets_ << " SETS, LRU" << endl;
+  out_stream << endl;
+
+  out_stream << "ACCESS         COUNT          HITS        MISSES  MISS RATE"
+             << endl;
+  for (int kind = 0; kind <= kHowManyKinds; ++kind) {
+    LONG count = (kind < kHowManyKinds) ? counts_[kind]
+                                        : this->GetAccesses();
+    LONG misses = (kind < kHowManyKinds) ? misses_[kind]
+                                         : this->GetMisses();
+    double rate = (count > 0) ? 100.0 * misses / count : 0.0;
+    out_stream << ((kind < kHowManyKinds) ? kKindNames[kind] : "TOTAL")
+               << Utils::Format(count, 14)
+               << Utils::Format(count - misses, 14)
+               << Utils::Format(misses, 14)
+               << Utils::Format(rate, 10, 2) << "%" << endl;
+  }
+  out_stream << "WRITEBACKS " << writebacks_ << endl;
+  out_stream << endl;
+
+  vector<int> pcs;
+  for (int pc = 0; pc < Globals::kMaxMemory; ++pc) {
+    if (fetch_misses_[pc] + data_misses_[pc] > 0) {
+      pcs.push_back(pc);
+    }
+  }
+  stable_sort(pcs.begin(), pcs.end(), [this](int a, int b) {
+    return fetch_misses_[a] + data_misses_[a] >
+           fetch_misses_[b] + data_misses_[b];
+  });
+
+  out_stream << "MISSES BY PC" << endl;
+  out_stream << "    PC  INSTRUCTION       FETCHES  FETCH MISSES"
+             << "   DATA ACCESSES   DATA MISSES  MISS RATE" << endl;
+  for (auto iter = pcs.begin(); iter != pcs.end(); ++iter) {
+    int pc = *iter;
+    string instruction = Interpreter::Disassemble(words_[pc]);
+    instruction.resize(max(static_cast<int>(instruction.length()), 11), ' ');
+    LONG count = fetch_counts_[pc] + data_counts_[pc];
+    LONG misses = fetch_misses_[pc] + data_misses_[pc];
+    double rate = (count > 0) ? 100.0 * misses / count : 0.0;
+    out_stream << Utils::Format(pc, 6) << "  " << instruction
+               << Utils::Format(fetch_counts_[pc], 14)
+               << Utils::Format(fetch_misses_[pc], 14)
+               << Utils::Format(data_counts_[pc], 16)
+               << Utils::Format(data_misses_[pc], 14)
+               << Utils::Format(rate, 10, 2) << "%" << endl;
+  }
+}
@@ -0,0 +1,143 @@
+/****************************************************************
+ * Header file for the Pullet16 memory cache simulator.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+#ifndef CACHE_H
+#define CACHE_H
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "../../Utilities/utils.h"
+
+#include "globals.h"
+
+class Cache {
+  public:
+    static const int kDefaultCapacity = 128;
+    static const int kDefaultLineSize = 4;
+    static const int kDefaultWays = 2;
+
+    static const int kFetch = 0;
+    static const int kRead = 1;
+    static const int kWrite = 2;
+    static const int kHowManyKinds = 3;
+
+    Cache();
+    virtual ~Cache();
+
+    LONG GetAccesses() const;
+    LONG GetMisses() const;
+
+    void Clear();
+    bool Configure(string geometry);
+    void WriteReport(ostream& out_stream) const;
+
+    /**************************************************************************
+     * Function 'Fetch'.
+     * The instruction 'word' at 'pc' is fetched.
+    **/
+    void Fetch(int pc, int word) {
+      words_[pc] = word;
+      bool is_hit = this->Access(pc, kFetch);
+      ++fetch_counts_[pc];
+      if (!is_hit) {
+        ++fetch_misses_[pc];
+      }
+    }
+
+    /**************************************************************************
+     * Function 'Read'.
+     * The instruction at 'pc' reads the word at 'address'.
+    **/
+    void Read(int pc, int address) {
+      bool is_hit = this->Access(address, kRead);
+      ++data_counts_[pc];
+      if (!is_hit) {
+        ++data_misses_[pc];
+      }
+    }
+
+    /**************************************************************************
+     * Function 'Write'.
+     * The instruction at 'pc' writes the word at 'address'.
+    **/
+    void Write(int pc, int address) {
+      bool is_hit = this->Access(address, kWrite);
+      ++data_counts_[pc];
+      if (!is_hit) {
+        ++data_misses_[pc];
+      }
+    }
+
+  private:
+    int capacity_;
+    int line_size_;
+    int how_many_ways_;
+    int how_many_sets_;
+
+    vector<int> address_lines_;
+    vector<int> address_sets_;
+    vector<int> entries_;
+
+    vector<LONG> counts_;
+    vector<LONG> misses_;
+    LONG writebacks_;
+
+    vector<int> words_;
+    vector<LONG> fetch_counts_;
+    vector<LONG> fetch_misses_;
+    vector<LONG> data_counts_;
+    vector<LONG> data_misses_;
+
+    /**************************************************************************
+     * Function 'Access'.
+     * Look up the line holding 'address' and bring it to the front of its
+     * set. The line and the start of the set for every address are worked
+     * out by 'Configure', so there is no division here.
+     *
+     * The ways of a set are kept most recently used first, so a hit moves
+     * its entry to the front and a miss drops the entry at the back, which
+     * is the least recently used. An entry is the line number times two
+     * plus one if the line has been written, and -1 if the way is empty.
+     *
+     * Returns:
+     *   true for a hit
+    **/
+    bool Access(int address, int kind) {
+      int line = address_lines_[address];
+      int* set = &entries_[address_sets_[address]];
+      int way = 0;
+      while ((way < how_many_ways_) && ((set[way] >> 1) != line)) {
+        ++way;
+      }
+
+      bool is_hit = (way < how_many_ways_);
+      int entry = line << 1;
+      ++counts_[kind];
+      if (is_hit) {
+        entry = set[way];
+      } else {
+        ++misses_[kind];
+        way = how_many_ways_ - 1;
+        if ((set[way] >= 0) && (set[way] & 1)) {
+          ++writebacks_;
+        }
+      }
+
+      for (; way > 0; --way) {
+        set[way] = set[way - 1];
+      }
+      set[0] = (kind == kWrite) ? (entry | 1) : entry;
+      return is_hit;
+    }
+};
+#endif
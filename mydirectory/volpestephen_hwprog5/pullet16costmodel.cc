@@ -0,0 +1,294 @@
+#include "pullet16costmodel.h"
+
+/******************************************************************************
+ *3456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
+ * Class 'CostModel' for charging simulated machine cycles.
+ *
+ * Two programs that execute the same number of instructions need not take
+ * the same time on a real machine: an instruction that goes to memory
+ * costs more than one that does not, an indirect address costs another
+ * trip to memory, and input and output cost far more than either. The
+ * cost model gives every instruction a cost in cycles from a table and
+ * adds them up, so that programs can be compared on simulated time.
+ *
+ * The cost of an instruction is
+ *   the cost of its mnemonic
+ *   plus 'INDIRECT' if it used an indirect address
+ *   plus 'TAKEN' if it is a branch that was taken
+ * An instruction that crashes is not charged.
+ *
+ * A table file has lines of a name and a cost, for instance
+ *   LD 2
+ *   INDIRECT 3
+ * where the names are the mnemonics, "???" for an illegal instruction,
+ * 'INDIRECT', and 'TAKEN'. Anything after a '#' is ignored, and a name
+ * that is not given keeps its default cost.
+ *
+ * Each run can be written as one line appended to a file of runs, and
+ * 'WriteComparison' reads such a file and compares the runs of each
+ * program. A line is
+ *   RUN program data table instructions cycles
+ * followed by the count and the cycles of each mnemonic, in the order of
+ * 'Globals::kMnemonicNames', and the number of indirect addresses and of
+ * branches taken.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+// BAN, SUB, STC, AND, ADD, LD, BR, RD, STP, WRT, and illegal.
+const int CostModel::kDefaultCosts[] = { 1, 2, 2, 2, 2, 2, 1, 20, 1, 20, 0 };
+
+/******************************************************************************
+ * Constructor
+**/
+CostModel::CostModel() {
+  table_name_ = "default";
+  costs_.assign(kDefaultCosts, kDefaultCosts + Globals::kHowManyMnemonics);
+  indirect_cost_ = kDefaultIndirectCost;
+  taken_cost_ = kDefaultTakenCost;
+  this->Clear();
+}
+
+/******************************************************************************
+ * Destructor
+**/
+CostModel::~CostModel() {
+}
+
+/******************************************************************************
+ * Accessors and Mutators
+**/
+
+/******************************************************************************
+ * Accessor for the total of the cycles charged.
+**/
+LONG CostModel::GetCycles() const {
+  LONG total = 0;
+  for (auto iter = cycles_.begin(); iter != cycles_.end(); ++iter) {
+    total += *iter;
+  }
+  return total;
+}
+
+/******************************************************************************
+ * Accessor for the number of instructions charged.
+**/
+LONG CostModel::GetInstructions() const {
+  LONG total = 0;
+  for (auto iter = counts_.begin(); iter != counts_.end(); ++iter) {
+    total += *iter;
+  }
+  return total;
+}
+
+/******************************************************************************
+ * Accessor for 'table_name_', the file the costs came from.
+**/
+string CostModel::GetTableName() const {
+  return table_name_;
+}
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'Clear'.
+ * Set the counts and the cycles back to zero, keeping the costs.
+**/
+void CostModel::Clear() {
+  counts_.assign(Globals::kHowManyMnemonics, 0);
+  cycles_.assign(Globals::kHowManyMnemonics, 0);
+  indirect_count_ = 0;
+  taken_count_ = 0;
+}
+
+/******************************************************************************
+ * Function 'LoadTable'.
+ * Read the costs from a table file.
+ *
+ * Parameter:
+ *   filename - the name of the table file
+ *
+ * Returns:
+ *   false if the file can't be read or has a line that makes no sense,
+ *   in which case the costs are left as they were
+**/
+bool CostModel::LoadTable(string filename) {
+  ifstream in_stream(filename.c_str());
+  if (!in_stream) {
+    return false;
+  }
+
+  vector<int> costs = costs_;
+  int indirect_cost = indirect_cost_;
+  int taken_cost = taken_cost_;
+
+  string line;
+  while (getline(in_stream, line)) {
+    if (line.find('#') != string::npos) {
+      line = line.substr(0, line.find('#'));
+    }
+    if (Utils::TrimView(line).empty()) {
+      continue;
+    }
+
+    istringstream line_stream(line);
+    string name;
+    int cost;
+    string extra;
+    if (!(line_stream >> name >> cost) || (line_stream >> extra) ||
+        (cost < 0)) {
+      return false;
+    }
+
+    if (name == "INDIRECT") {
+      indirect_cost = cost;
+    } else if (name == "TAKEN") {
+      taken_cost = cost;
+    } else {
+      int mnemonic = 0;
+      while ((mnemonic < Globals::kHowManyMnemonics) &&
+             (name != Globals::kMnemonicNames[mnemonic])) {
+        ++mnemonic;
+      }
+      if (mnemonic == Globals::kHowManyMnemonics) {
+        return false;
+      }
+      costs[mnemonic] = cost;
+    }
+  }
+
+  costs_ = costs;
+  indirect_cost_ = indirect_cost;
+  taken_cost_ = taken_cost;
+  table_name_ = filename.substr(filename.find_last_of('/') + 1);
+  return true;
+}
+
+/******************************************************************************
+ * Function 'WriteComparison'.
+ * Read a file of runs and compare the runs of each program, first on the
+ * totals and then on the cycles spent in each kind of instruction. The
+ * change in cycles is against the first run of the program in the file.
+ *
+ * Parameters:
+ *   runs_filename - the file the runs were appended to
+ *   out_stream - where to write the comparison
+ *
+ * Returns:
+ *   false if the file can't be read
+**/
+bool CostModel::WriteComparison(string runs_filename, ostream& out_stream) {
+  ifstream in_stream(runs_filename.c_str());
+  if (!in_stream) {
+    return false;
+  }
+
+  // The programs in the order they first appear, and their runs.
+  vector<string> programs;
+  vector<vector<Run> > runs;
+  string line;
+  while (getline(in_stream, line)) {
+    istringstream line_stream(line);
+    string keyword;
+    Run run;
+    if (!(line_stream >> keyword >> run.program >> run.data
+                      >> run.table_name >> run.instructions >> run.cycles) ||
+        (keyword != "RUN")) {
+      continue;
+    }
+    run.cycles_by_mnemonic.assign(Globals::kHowManyMnemonics, 0);
+    for (int mnemonic = 0; mnemonic < Globals::kHowManyMnemonics;
+         ++mnemonic) {
+      LONG count = 0;
+      line_stream >> count >> run.cycles_by_mnemonic[mnemonic];
+    }
+
+    UINT which = find(programs.begin(), programs.end(), run.program)
+               - programs.begin();
+    if (which == programs.size()) {
+      programs.push_back(run.program);
+      runs.push_back(vector<Run>());
+    }
+    runs[which].push_back(run);
+  }
+
+  out_stream << "COST COMPARISON OF THE RUNS IN '" << runs_filename << "'"
+             << endl;
+  for (UINT which = 0; which < programs.size(); ++which) {
+    const vector<Run>& program_runs = runs[which];
+    double first_cycles = static_cast<double>(program_runs[0].cycles);
+
+    out_stream << endl;
+    out_stream << "PROGRAM " << programs[which] << endl;
+    out_stream << " RUN  DATA             TABLE            INSTRUCTIONS"
+               << "          CYCLES  CYCLES/INSTR  VS FIRST" << endl;
+    for (UINT sub = 0; sub < program_runs.size(); ++sub) {
+      const Run& run = program_runs[sub];
+      double per_instruction = (run.instructions > 0)
+          ? static_cast<double>(run.cycles) / run.instructions : 0.0;
+      double change = (first_cycles > 0)
+          ? 100.0 * (run.cycles - first_cycles) / first_cycles : 0.0;
+      string data = run.data;
+      string table_name = run.table_name;
+      data.resize(max(static_cast<int>(data.length()), 15), ' ');
+      table_name.resize(max(static_cast<int>(table_name.length()), 15), ' ');
+      out_stream << Utils::Format(static_cast<int>(sub + 1), 4) << "  "
+                 << data << "  " << table_name
+                 << Utils::Format(run.instructions, 14)
+                 << Utils::Format(run.cycles, 16)
+                 << Utils::Format(per_instruction, 14, 2)
+                 << Utils::Format(change, 9, 2) << "%" << endl;
+    }
+
+    // Only the kinds of instruction that any of the runs spent time in.
+    out_stream << " CYCLES BY INSTRUCTION" << endl;
+    out_stream << " RUN";
+    vector<int> mnemonics;
+    for (int mnemonic = 0; mnemonic < Globals::kHowManyMnemonics;
+         ++mnemonic) {
+      for (UINT sub = 0; sub < program_runs.size(); ++sub) {
+        if (program_runs[sub].cycles_by_mnemonic[mnemonic] > 0) {
+          mnemonics.push_back(mnemonic);
+          out_stream << Utils::Format(Globals::kMnemonicNames[mnemonic], 12);
+          break;
+        }
+      }
+    }
+    out_stream << endl;
+    for (UINT sub = 0; sub < program_runs.size(); ++sub) {
+      out_stream << Utils::Format(static_cast<int>(sub + 1), 4);
+      for (auto iter = mnemonics.begin(); iter != mnemonics.end(); ++iter) {
+        out_stream << Utils::Format(program_runs[sub].cycles_by_mnemonic[*iter],
+                                    12);
+      }
+      out_stream << endl;
+    }
+  }
+
+  return true;
+}
+
+/******************************************************************************
+ * Function 'WriteRun'.
+ * Write the totals of this run as one line for the file of runs.
+ *
+ * Parameters:
+ *   out_stream - where to write
+ *   program - the name of the program that was run
+ *   data - the name of its input
+**/
+void CostModel::WriteRun(ostream& out_stream, string program,
+                         string data) const {
+  out_stream << "RUN " << Utils::ReplaceBlanks(program, '_') << " "
+             << Utils::ReplaceBlanks(data, '_') << " "
+             << Utils::ReplaceBlanks(table_name_, '_') << " "
+             << this->GetInstructions() << " " << this->GetCycles();
+  for (int mnemonic = 0; mnemonic < Globals::kHowManyMnemonics; ++mnemonic) {
+    out_stream << " " << counts_[mnemonic] << " " << cycles_[mnemonic];
+  }
+  out_stream << " " << indirect_count_ << " " << taken_count_ << endl;
+}
@@ -0,0 +1,87 @@
+/****************************************************************
+ * Header file for the Pullet16 simulated cycle cost model.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+#ifndef COSTMODEL_H
+#define COSTMODEL_H
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "../../Utilities/utils.h"
+
+#include "globals.h"
+
+class CostModel {
+  public:
+    static const int kDefaultCosts[];
+    static const int kDefaultIndirectCost = 2;
+    static const int kDefaultTakenCost = 1;
+
+    CostModel();
+    virtual ~CostModel();
+
+    LONG GetCycles() const;
+    LONG GetInstructions() const;
+    string GetTableName() const;
+
+    void Clear();
+    bool LoadTable(string filename);
+    void WriteRun(ostream& out_stream, string program, string data) const;
+
+    static bool WriteComparison(string runs_filename, ostream& out_stream);
+
+    /**************************************************************************
+     * Function 'Charge'.
+     * Add the cost of one executed instruction 'word'. 'used_address' says
+     * that the instruction went to memory for its target, which for a BAN
+     * means that the branch was taken. This is on the path of every
+     * instruction, so it is inline.
+    **/
+    void Charge(int word, bool used_address) {
+      int mnemonic = Globals::MnemonicIndex(word);
+      LONG cycles = costs_[mnemonic];
+      if (used_address) {
+        if (((word >> 12) & 1) && (mnemonic < Globals::kRD)) {
+          cycles += indirect_cost_;
+          ++indirect_count_;
+        }
+        if ((mnemonic == Globals::kBAN) || (mnemonic == Globals::kBR)) {
+          cycles += taken_cost_;
+          ++taken_count_;
+        }
+      }
+      ++counts_[mnemonic];
+      cycles_[mnemonic] += cycles;
+    }
+
+  private:
+    struct Run {
+      string program;
+      string data;
+      string table_name;
+      LONG instructions;
+      LONG cycles;
+      vector<LONG> cycles_by_mnemonic;
+    };
+
+    string table_name_;
+    vector<int> costs_;
+    int indirect_cost_;
+    int taken_cost_;
+
+    vector<LONG> counts_;
+    vector<LONG> cycles_;
+    LONG indirect_count_;
+    LONG taken_count_;
+};
+#endif
@@ -0,0 +1,116 @@
+#include "pullet16debugger.h"
+
+/******************************************************************************
+ *3456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
+ * Class 'Debugger' for moving backward and forward through a recorded run.
+ *
+ * The program is first run to the end with the interpreter recording, as
+ * usual except for the checkpoints and the log of the values read by RD.
+ * The debugger then reads commands and puts the machine at any instruction
+ * of that run with 'Interpreter::SeekTo', which restores the nearest
+ * checkpoint and re-executes from there. Nothing has to be read from the
+ * multi-gigabyte trace of a full dump.
+ *
+ * Commands:
+ *   s [n]  step forward n instructions (default 1)
+ *   b [n]  step backward n instructions (default 1)
+ *   g i    go to instruction i
+ *   p      print the machine
+ *   q      quit
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+**/
+
+static const string kTag = "DEBUG: ";
+
+/******************************************************************************
+ * Constructor
+**/
+Debugger::Debugger() {
+}
+
+/******************************************************************************
+ * Destructor
+**/
+Debugger::~Debugger() {
+}
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'Run'.
+ * Read and carry out commands until 'q' or the end of the input.
+ *
+ * Parameters:
+ *   interpreter - the interpreter, after a recorded run
+ *   in_stream - where the commands come from
+ *   out_stream - where the answers go
+**/
+void Debugger::Run(Interpreter& interpreter, istream& in_stream,
+                   ostream& out_stream) {
+  interpreter.StopRecording();
+  int last_index = interpreter.GetInstructionCount();
+
+  out_stream << kTag << "recorded " << last_index << " instructions";
+  if (interpreter.IsFaulted()) {
+    out_stream << ", ending in a crash";
+  }
+  out_stream << endl;
+  interpreter.SeekTo(last_index);
+  this->ShowPosition(interpreter, out_stream);
+
+  string line;
+  while (getline(in_stream, line)) {
+    line = Utils::Trim(line);
+    if (line == "") continue;
+
+    char command = line.at(0);
+    bool has_number = (line.length() > 1);
+    int number = has_number ? atoi(line.substr(1).c_str()) : 1;
+    int index = interpreter.GetInstructionCount();
+
+    if (command == 'q') {
+      break;
+    } else if (command == 'p') {
+      out_stream << interpreter.ToString() << endl;
+      continue;
+    } else if (command == 's') {
+      index += number;
+    } else if (command == 'b') {
+      index -= number;
+    } else if ((command == 'g') && has_number) {
+      index = number;
+    } else {
+      out_stream << kTag << "commands are s [n], b [n], g i, p, q" << endl;
+      continue;
+    }
+
+    if (index < 0) index = 0;
+    if (index > last_index) index = last_index;
+    interpreter.SeekTo(index);
+    this->ShowPosition(interpreter, out_stream);
+  }
+}
+
+/******************************************************************************
+ * Function 'ShowPosition'.
+ * Show where the machine is and the instruction it will execute next.
+**/
+void Debugger::ShowPosition(Interpreter& interpreter, ostream& out_stream) {
+  int pc = interpreter.GetPC();
+  int accum = interpreter.GetAccum();
+  int twoscomplement = (accum > 32768) ? accum - 65536 : accum;
+
+  out_stream << kTag << "instruction "
+             << Utils::Format(interpreter.GetInstructionCount(), 8)
+             << "  PC " << Utils::Format(pc, 4)
+             << "  ACCUM " << Utils::Format(twoscomplement, 6);
+  if (pc < interpreter.GetMemorySize()) {
+    out_stream << "  NEXT "
+               << Interpreter::Disassemble(interpreter.GetMemoryWord(pc));
+  }
+  out_stream << endl;
+}
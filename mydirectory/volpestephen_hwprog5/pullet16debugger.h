@@ -0,0 +1,33 @@
+/****************************************************************
+ * Header file for the Pullet16 time-travel debugger.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+#include "../../Utilities/utils.h"
+
+#include "pullet16interpreter.h"
+
+class Debugger {
+  public:
+    static const int kDefaultCheckpointInterval = 1000;
+
+    Debugger();
+    virtual ~Debugger();
+
+    void Run(Interpreter& interpreter, istream& in_stream,
+             ostream& out_stream);
+
+  private:
+    void ShowPosition(Interpreter& interpreter, ostream& out_stream);
+};
+#endif
@@ -0,0 +1,94 @@
+/****************************************************************
+ * Generator of synthetic Pullet16 programs, for benchmarks and
+ * stress tests.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+ * Usage: pullet16gen [--size=words] [--depth=loops]
+ *                    [--iterations=n] [--indirect=ratio]
+ *                    [--io=density] [--self-modify=rate]
+ *                    [--seed=s] execfilename datafilename
+ *
+ * This writes 'execfilename.txt' and 'execfilename.bin', an
+ * executable of 'words' words that 'Aprog' loads as it would one
+ * from the assembler, and 'datafilename.txt', the values for its
+ * RDs. The program is described in 'pullet16generator.cc'. As
+ * for 'Aprog', the file names have no extensions.
+ *
+ * What it reports includes the '--max-instructions' that lets
+ * 'Aprog' run the program to its STP.
+**/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "pullet16generator.h"
+
+static const string kTag = "GEN: ";
+static const string kUsage = "[--size=words] [--depth=loops] "
+                             "[--iterations=n] [--indirect=ratio] "
+                             "[--io=density] [--self-modify=rate] "
+                             "[--seed=s] execfilename datafilename";
+
+int main(int argc, char *argv[]) {
+  Generator::Parameters parameters = Generator::DefaultParameters();
+  int argsub = 1;
+  while ((argsub < argc) && (string(argv[argsub]).substr(0, 2) == "--")) {
+    string option = argv[argsub];
+    string value = "";
+    if (option.find('=') != string::npos) {
+      value = option.substr(option.find('=') + 1);
+      option = option.substr(0, option.find('='));
+    }
+
+    if (option == "--size") {
+      parameters.size = atoi(value.c_str());
+    } else if (option == "--depth") {
+      parameters.depth = atoi(value.c_str());
+    } else if (option == "--iterations") {
+      parameters.iterations = atoi(value.c_str());
+    } else if (option == "--indirect") {
+      parameters.indirect_ratio = atof(value.c_str());
+    } else if (option == "--io") {
+      parameters.io_density = atof(value.c_str());
+    } else if (option == "--self-modify") {
+      parameters.self_modify_rate = atof(value.c_str());
+    } else if (option == "--seed") {
+      parameters.seed = static_cast<unsigned int>(atoll(value.c_str()));
+    } else {
+      cout << kTag << "unknown option '" << option << "'" << endl;
+      cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+      return 1;
+    }
+    ++argsub;
+  }
+  if (argc - argsub != 2) {
+    cout << kTag << "usage: " << argv[0] << " " << kUsage << endl;
+    return 1;
+  }
+  string exec_basename = argv[argsub];
+  string data_filename = static_cast<string>(argv[argsub + 1]) + ".txt";
+
+  Generator generator;
+  if (!generator.Generate(parameters)) {
+    cout << kTag << generator.GetError() << endl;
+    return 1;
+  }
+  if (!Generator::WriteExecutable(generator.GetWords(), exec_basename)) {
+    cout << kTag << "unable to write '" << exec_basename << "'" << endl;
+    return 1;
+  }
+  if (!generator.WriteData(data_filename)) {
+    cout << kTag << "unable to write '" << data_filename << "'" << endl;
+    return 1;
+  }
+
+  cout << kTag << generator.GetWords().size() << " WORDS, "
+       << generator.GetInstructionCount() << " INSTRUCTIONS, "
+       << generator.GetReadCount() << " READS" << endl;
+  cout << kTag << "run with --max-instructions="
+       << (generator.GetInstructionCount() + 1) << endl;
+  return 0;
+}
@@ -0,0 +1,409 @@
+#include "pullet16generator.h"
+
+#include <climits>
+#include <cstdio>
+#include <fstream>
+
+/******************************************************************************
+ *3456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
+ * Class 'Generator' for making synthetic Pullet16 programs.
+ *
+ * A program is loops nested 'depth' deep, each going around 'iterations'
+ * times, and then STP, so how long it runs is known before it is run. The
+ * image is exactly 'size' words, with the code at the bottom and the data
+ * the code uses at the top:
+ *   the constants 1 and a mask, 1111111111111101
+ *   for each loop, the starting count, which is minus 'iterations', and
+ *   the count itself
+ *   pointers, each to a scratch word, for the indirect operations
+ *   scratch words, on a multiple of four, for everything else
+ * with zeros between the code and the data and in the few words that
+ * may be left after the scratch words.
+ *
+ * Each loop starts by copying its starting count into its count, then
+ * does its body and the loop inside it, and ends by adding one to the
+ * count and branching back with BAN while the count is negative:
+ *     LD  start
+ *     STC count
+ *   top:
+ *     ...
+ *     LD  count
+ *     ADD one
+ *     STC count
+ *     LD  count
+ *     BAN top
+ * The words for bodies are shared out evenly among the loops, with any
+ * left over going to the innermost. An operation of a body is one of
+ *   ADD, SUB, AND, LD, or STC on a scratch word, or indirectly through a
+ *   pointer with probability 'indirect_ratio'
+ *   RD or WRT, with probability 'io_density'
+ *   with probability 'self_modify_rate', an ADD, SUB, AND, or LD on the
+ *   scratch word at a multiple of four, after four instructions that add
+ *   one to its own word and mask off bit 1, so that its target goes back
+ *   and forth between the first two scratch words of that four
+ * Nothing a body does changes which way a branch goes, so we count the
+ * instructions and the RDs as we write them, each times how many times
+ * its loops go around. The data for RD is that many values.
+ *
+ * Random choices are made with the same linear congruential generator as
+ * the benchmarks use, so a seed always gives the same program.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+static const int kOpcodeBAN = 0;
+static const int kOpcodeSUB = 1;
+static const int kOpcodeSTC = 2;
+static const int kOpcodeAND = 3;
+static const int kOpcodeADD = 4;
+static const int kOpcodeLD = 5;
+static const int kOpcodeIO = 7;
+static const int kTargetRD = 1;
+static const int kTargetSTP = 2;
+static const int kTargetWRT = 3;
+
+/******************************************************************************
+ * Function 'Word', the machine word for an opcode, an indirect bit, and a
+ * target.
+**/
+static int Word(int opcode, int indirect, int target) {
+  return (opcode << 13) | (indirect << 12) | target;
+}
+
+/******************************************************************************
+ * Constructor
+**/
+Generator::Generator() {
+  parameters_ = DefaultParameters();
+  error_ = "";
+  seed_ = 0;
+  instruction_count_ = 0;
+  read_count_ = 0;
+  code_size_ = 0;
+  one_address_ = 0;
+  mask_address_ = 0;
+  first_counter_address_ = 0;
+  first_pointer_address_ = 0;
+  first_scratch_address_ = 0;
+}
+
+/******************************************************************************
+ * Destructor
+**/
+Generator::~Generator() {
+}
+
+/******************************************************************************
+ * Accessors and Mutators
+**/
+
+/******************************************************************************
+ * Accessor for 'error_', why 'Generate' failed.
+**/
+string Generator::GetError() const {
+  return error_;
+}
+
+/******************************************************************************
+ * Accessor for 'instruction_count_', the instructions the program executes
+ * before its STP, which is the count the interpreter reports.
+**/
+LONG Generator::GetInstructionCount() const {
+  return instruction_count_;
+}
+
+/******************************************************************************
+ * Accessor for 'read_count_', the RDs the program executes.
+**/
+LONG Generator::GetReadCount() const {
+  return read_count_;
+}
+
+/******************************************************************************
+ * Accessor for 'words_', the image.
+**/
+const vector<int>& Generator::GetWords() const {
+  return words_;
+}
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'Chance'.
+ *
+ * Returns:
+ *   true with probability 'ratio'
+**/
+bool Generator::Chance(double ratio) {
+  return this->Random(10000) < static_cast<int>(ratio * 10000.0);
+}
+
+/******************************************************************************
+ * Function 'DefaultParameters'.
+**/
+Generator::Parameters Generator::DefaultParameters() {
+  Parameters parameters;
+  parameters.size = kDefaultSize;
+  parameters.depth = kDefaultDepth;
+  parameters.iterations = kDefaultIterations;
+  parameters.indirect_ratio = 0.25;
+  parameters.io_density = 0.05;
+  parameters.self_modify_rate = 0.02;
+  parameters.seed = 1;
+  return parameters;
+}
+
+/******************************************************************************
+ * Function 'Emit', to put the next word of code in the image.
+ *
+ * Parameters:
+ *   word - the instruction
+ *   multiplicity - how many times it will be executed
+**/
+void Generator::Emit(int word, LONG multiplicity) {
+  words_[code_size_] = word;
+  ++code_size_;
+  instruction_count_ += multiplicity;
+}
+
+/******************************************************************************
+ * Function 'EmitBody', to write the operations of a loop body.
+ *
+ * Parameters:
+ *   how_many_words - the words of code the body is to have
+ *   multiplicity - how many times the body will be executed
+**/
+void Generator::EmitBody(int how_many_words, LONG multiplicity) {
+  static const int kMemoryOpcodes[] = { kOpcodeADD, kOpcodeSUB, kOpcodeAND,
+                                        kOpcodeLD, kOpcodeSTC };
+  while (how_many_words > 0) {
+    if ((how_many_words >= kSelfModifyLength) &&
+        this->Chance(parameters_.self_modify_rate)) {
+      int site = code_size_ + kSelfModifyLength - 1;
+      int target = first_scratch_address_ +
+                   4 * this->Random(kHowManyScratch / 4);
+      int opcode = kMemoryOpcodes[this->Random(4)];
+      this->Emit(Word(kOpcodeLD, 0, site), multiplicity);
+      this->Emit(Word(kOpcodeADD, 0, one_address_), multiplicity);
+      this->Emit(Word(kOpcodeAND, 0, mask_address_), multiplicity);
+      this->Emit(Word(kOpcodeSTC, 0, site), multiplicity);
+      this->Emit(Word(opcode, 0, target), multiplicity);
+      how_many_words -= kSelfModifyLength;
+    } else if (this->Chance(parameters_.io_density)) {
+      if (0 == this->Random(2)) {
+        this->Emit(Word(kOpcodeIO, 0, kTargetRD), multiplicity);
+        read_count_ += multiplicity;
+      } else {
+        this->Emit(Word(kOpcodeIO, 0, kTargetWRT), multiplicity);
+      }
+      --how_many_words;
+    } else {
+      int opcode = kMemoryOpcodes[this->Random(5)];
+      if (this->Chance(parameters_.indirect_ratio)) {
+        int pointer = first_pointer_address_ +
+                      this->Random(kHowManyPointers);
+        this->Emit(Word(opcode, 1, pointer), multiplicity);
+      } else {
+        int target = first_scratch_address_ +
+                     this->Random(kHowManyScratch);
+        this->Emit(Word(opcode, 0, target), multiplicity);
+      }
+      --how_many_words;
+    }
+  }
+}
+
+/******************************************************************************
+ * Function 'EmitLoop', to write loop 'level' and the loops inside it.
+ *
+ * Parameters:
+ *   level - which loop, from 1 for the outermost
+ *   multiplicity - how many times the loop will be started
+ *   body_sizes - the words of body for each level
+**/
+void Generator::EmitLoop(int level, LONG multiplicity,
+                         const vector<int>& body_sizes) {
+  int start_address = first_counter_address_ + 2 * (level - 1);
+  int count_address = start_address + 1;
+  this->Emit(Word(kOpcodeLD, 0, start_address), multiplicity);
+  this->Emit(Word(kOpcodeSTC, 0, count_address), multiplicity);
+
+  LONG inner_multiplicity = multiplicity * parameters_.iterations;
+  int top = code_size_;
+  this->EmitBody(body_sizes[level], inner_multiplicity);
+  if (level < parameters_.depth) {
+    this->EmitLoop(level + 1, inner_multiplicity, body_sizes);
+  }
+
+  this->Emit(Word(kOpcodeLD, 0, count_address), inner_multiplicity);
+  this->Emit(Word(kOpcodeADD, 0, one_address_), inner_multiplicity);
+  this->Emit(Word(kOpcodeSTC, 0, count_address), inner_multiplicity);
+  this->Emit(Word(kOpcodeLD, 0, count_address), inner_multiplicity);
+  this->Emit(Word(kOpcodeBAN, 0, top), inner_multiplicity);
+}
+
+/******************************************************************************
+ * Function 'Generate', to make a program.
+ *
+ * Returns:
+ *   false, with 'GetError' saying why, if the parameters are out of range
+ *   or the program would run for more instructions than the interpreter
+ *   can count
+**/
+bool Generator::Generate(const Parameters& parameters) {
+  error_ = "";
+  words_.clear();
+  code_size_ = 0;
+  instruction_count_ = 0;
+  read_count_ = 0;
+
+  if ((parameters.size < kHowManyScratch) ||
+      (parameters.size > Globals::kMaxMemory)) {
+    error_ = "the size must be from " + Utils::Format(kHowManyScratch) +
+             " to " + Utils::Format(Globals::kMaxMemory);
+    return false;
+  }
+  if ((parameters.depth < 0) || (parameters.iterations < 1) ||
+      (parameters.iterations > 32767)) {
+    error_ = "the depth must be at least 0 and the iterations from 1 to "
+             "32767";
+    return false;
+  }
+  if ((parameters.indirect_ratio < 0.0) || (parameters.indirect_ratio > 1.0) ||
+      (parameters.io_density < 0.0) || (parameters.io_density > 1.0) ||
+      (parameters.self_modify_rate < 0.0) ||
+      (parameters.self_modify_rate > 1.0)) {
+    error_ = "the ratios must be from 0 to 1";
+    return false;
+  }
+  parameters_ = parameters;
+  seed_ = parameters.seed;
+
+  // The data, from the top down.
+  first_scratch_address_ = ((parameters.size - kHowManyScratch) / 4) * 4;
+  first_pointer_address_ = first_scratch_address_ - kHowManyPointers;
+  first_counter_address_ = first_pointer_address_ - 2 * parameters.depth;
+  mask_address_ = first_counter_address_ - 1;
+  one_address_ = mask_address_ - 1;
+  int body_words = one_address_ - 1 - kLoopOverhead * parameters.depth;
+  if (body_words < 0) {
+    error_ = "the size " + Utils::Format(parameters.size) +
+             " is too small for loops " + Utils::Format(parameters.depth) +
+             " deep";
+    return false;
+  }
+
+  LONG multiplicity = 1;
+  for (int level = 1; level <= parameters.depth; ++level) {
+    multiplicity *= parameters.iterations;
+    if (multiplicity > INT_MAX) {
+      error_ = "the program would run for more than " +
+               Utils::Format(INT_MAX) + " instructions";
+      return false;
+    }
+  }
+
+  words_.assign(parameters.size, 0);
+  words_[one_address_] = 1;
+  words_[mask_address_] = 0xFFFD;
+  for (int level = 1; level <= parameters.depth; ++level) {
+    words_[first_counter_address_ + 2 * (level - 1)] =
+        65536 - parameters.iterations;
+  }
+  for (int pointer = 0; pointer < kHowManyPointers; ++pointer) {
+    words_[first_pointer_address_ + pointer] =
+        first_scratch_address_ + this->Random(kHowManyScratch);
+  }
+  for (int scratch = 0; scratch < kHowManyScratch; ++scratch) {
+    words_[first_scratch_address_ + scratch] = this->Random(65536);
+  }
+
+  vector<int> body_sizes(parameters.depth + 1, 0);
+  if (0 == parameters.depth) {
+    body_sizes[0] = body_words;
+    this->EmitBody(body_sizes[0], 1);
+  } else {
+    for (int level = 1; level <= parameters.depth; ++level) {
+      body_sizes[level] = body_words / parameters.depth;
+    }
+    body_sizes[parameters.depth] += body_words % parameters.depth;
+    this->EmitLoop(1, 1, body_sizes);
+  }
+  // The interpreter doesn't count the STP.
+  this->Emit(Word(kOpcodeIO, 0, kTargetSTP), 0);
+
+  if (instruction_count_ >= INT_MAX) {
+    error_ = "the program would run for more than " +
+             Utils::Format(INT_MAX) + " instructions";
+    return false;
+  }
+  return true;
+}
+
+/******************************************************************************
+ * Function 'Random'.
+ *
+ * Returns:
+ *   a random number from 0 to 'how_many' - 1
+**/
+int Generator::Random(int how_many) {
+  seed_ = seed_ * 1103515245 + 12345;
+  return static_cast<int>(((seed_ >> 8) & 0xFFFFFF) % how_many);
+}
+
+/******************************************************************************
+ * Function 'WriteData', to write the values the RDs of the program read,
+ * one to a line as signed hex.
+ *
+ * Returns:
+ *   false if the file can't be written
+**/
+bool Generator::WriteData(string filename) const {
+  FILE* data_file = fopen(filename.c_str(), "w");
+  if (NULL == data_file) {
+    return false;
+  }
+  unsigned int seed = parameters_.seed;
+  for (LONG sub = 0; sub < read_count_; ++sub) {
+    seed = seed * 1103515245 + 12345;
+    int value = (seed >> 16) & 0x7FFF;
+    fprintf(data_file, "%c%04X\n", (seed & 0x100) ? '-' : '+', value);
+  }
+  return 0 == fclose(data_file);
+}
+
+/******************************************************************************
+ * Function 'WriteExecutable', to write the text and binary files of an
+ * image as the assembler would, one line of sixteen bits per word and the
+ * words high byte first.
+ *
+ * Parameters:
+ *   words - the image
+ *   basename - the file names without '.txt' and '.bin'
+ * Returns:
+ *   false if the files can't be written
+**/
+bool Generator::WriteExecutable(const vector<int>& words, string basename) {
+  Globals globals;
+  ofstream text_stream((basename + ".txt").c_str());
+  FILE* binary_file = fopen((basename + ".bin").c_str(), "wb");
+  if (!text_stream || (NULL == binary_file)) {
+    if (NULL != binary_file) {
+      fclose(binary_file);
+    }
+    return false;
+  }
+  for (auto iter = words.begin(); iter != words.end(); ++iter) {
+    text_stream << globals.DecToBitString(*iter, 16) << endl;
+    unsigned char bytes[2] = { static_cast<unsigned char>(*iter >> 8),
+                               static_cast<unsigned char>(*iter & 255) };
+    fwrite(bytes, 1, 2, binary_file);
+  }
+  bool is_ok = (0 == fclose(binary_file));
+  text_stream.close();
+  return is_ok && !text_stream.fail();
+}
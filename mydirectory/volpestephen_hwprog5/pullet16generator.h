@@ -0,0 +1,86 @@
+/****************************************************************
+ * Header file for the generator of synthetic Pullet16 programs.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "../../Utilities/utils.h"
+
+#include "globals.h"
+
+class Generator {
+  public:
+    static const int kDefaultSize = 1024;
+    static const int kDefaultDepth = 2;
+    static const int kDefaultIterations = 10;
+
+    /**************************************************************************
+     * What to generate. The ratios are each from 0 to 1:
+     *   indirect_ratio - of the memory operations, how many are indirect
+     *   io_density - of the operations of a loop body, how many are RD or
+     *                WRT
+     *   self_modify_rate - of the operations of a loop body, how many
+     *                      rewrite the instruction after them first
+    **/
+    struct Parameters {
+      int size;
+      int depth;
+      int iterations;
+      double indirect_ratio;
+      double io_density;
+      double self_modify_rate;
+      unsigned int seed;
+    };
+
+    Generator();
+    virtual ~Generator();
+
+    string GetError() const;
+    LONG GetInstructionCount() const;
+    LONG GetReadCount() const;
+    const vector<int>& GetWords() const;
+
+    bool Generate(const Parameters& parameters);
+    bool WriteData(string filename) const;
+
+    static Parameters DefaultParameters();
+    static bool WriteExecutable(const vector<int>& words, string basename);
+
+  private:
+    static const int kHowManyPointers = 8;
+    static const int kHowManyScratch = 16;
+    static const int kLoopOverhead = 7;
+    static const int kSelfModifyLength = 5;
+
+    Parameters parameters_;
+    string error_;
+    unsigned int seed_;
+    LONG instruction_count_;
+    LONG read_count_;
+    vector<int> words_;
+    int code_size_;
+
+    int one_address_;
+    int mask_address_;
+    int first_counter_address_;
+    int first_pointer_address_;
+    int first_scratch_address_;
+
+    bool Chance(double ratio);
+    void Emit(int word, LONG multiplicity);
+    void EmitBody(int how_many_words, LONG multiplicity);
+    void EmitLoop(int level, LONG multiplicity,
+                  const vector<int>& body_sizes);
+    int Random(int how_many);
+};
+#endif
@@ -27,10 +27,32 @@
  * Date: 1 November 2017
 **/
 
+static const char kReplayMagic[] = "P16R";
+static const UINT kHashBasis = 2166136261u;
+static const UINT kHashPrime = 16777619u;
+
 /******************************************************************************
  * Constructor
 **/
 Interpreter::Interpreter() {
+  exit_on_fault_ = true;
+  is_faulted_ = false;
+  is_recording_ = false;
+  is_replaying_input_ = false;
+  checkpoint_interval_ = 0;
+  next_checkpoint_ = 0;
+  input_count_ = 0;
+  instruction_count_ = 0;
+  memory_size_ = 0;
+  image_hash_ = kHashBasis;
+  max_instructions_ = kMaxInstrCount;
+  trace_level_ = kTraceFull;
+  trace_writer_ = NULL;
+  profiler_ = NULL;
+  cost_model_ = NULL;
+  cache_ = NULL;
+  log_stream_ = &Utils::log_stream;
+  last_location_ = 0;
 }
 
 /******************************************************************************
@@ -43,10 +65,243 @@ Interpreter::~Interpreter() {
  * Accessors and Mutators
 **/
 
+/******************************************************************************
+ * Accessor for 'accum_'.
+**/
+int Interpreter::GetAccum() const {
+  return accum_;
+}
+
+/******************************************************************************
+ * Mutator for 'exit_on_fault_'.
+ *
+ * By default a crash of the program being interpreted ends this program
+ * too, just as the original interpreter did. With 'false', the crash is
+ * logged and the run stops, and 'IsFaulted' is true afterwards.
+**/
+void Interpreter::SetExitOnFault(bool value) {
+  exit_on_fault_ = value;
+}
+
+/******************************************************************************
+ * Accessor for 'input_count_', the number of values RD has read.
+**/
+int Interpreter::GetInputCount() const {
+  return input_count_;
+}
+
+/******************************************************************************
+ * Accessor for 'instruction_count_'.
+**/
+int Interpreter::GetInstructionCount() const {
+  return instruction_count_;
+}
+
+/******************************************************************************
+ * Accessor for 'is_faulted_'.
+**/
+bool Interpreter::IsFaulted() const {
+  return is_faulted_;
+}
+
+/******************************************************************************
+ * Accessor for the size of the loaded executable.
+**/
+int Interpreter::GetMemorySize() const {
+  return memory_size_;
+}
+
+/******************************************************************************
+ * Accessor for one word of memory. Addresses outside of memory read as 0.
+**/
+int Interpreter::GetMemoryWord(int address) const {
+  if ((address < 0) || (address >= globals_.kMaxMemory)) {
+    return 0;
+  }
+  return this->ReadMemory(address);
+}
+
+/******************************************************************************
+ * Accessor for 'log_stream_'.
+**/
+ostream& Interpreter::GetLogStream() const {
+  return *log_stream_;
+}
+
+/******************************************************************************
+ * Mutator for 'log_stream_', the stream the trace and the error messages
+ * are written to. It is 'Utils::log_stream' unless this is called.
+ *
+ * The interpreter keeps no other state that is shared with other
+ * instances, so interpreters with streams of their own can be run at the
+ * same time on separate threads. The stream must outlive the interpreter.
+**/
+void Interpreter::SetLogStream(ostream& log_stream) {
+  log_stream_ = &log_stream;
+}
+
+/******************************************************************************
+ * Accessor for 'max_instructions_'.
+**/
+int Interpreter::GetMaxInstructions() const {
+  return max_instructions_;
+}
+
+/******************************************************************************
+ * Mutator for 'max_instructions_', the count at which a run times out.
+**/
+void Interpreter::SetMaxInstructions(int how_many) {
+  max_instructions_ = how_many;
+}
+
+/******************************************************************************
+ * Accessor for 'pc_'.
+**/
+int Interpreter::GetPC() const {
+  return pc_;
+}
+
+/******************************************************************************
+ * Accessor for 'trace_level_'.
+**/
+int Interpreter::GetTraceLevel() const {
+  return trace_level_;
+}
+
+/******************************************************************************
+ * Mutator for 'trace_level_'.
+ *
+ * The levels are
+ *   kTraceNone         - nothing but error messages goes to the log
+ *   kTraceInstructions - one block of lines for each instruction executed
+ *   kTraceFull         - the instruction lines and a full machine dump
+ *                        after every instruction (the original behavior)
+**/
+void Interpreter::SetTraceLevel(int level) {
+  trace_level_ = level;
+}
+
+/******************************************************************************
+ * Mutator for 'trace_writer_'.
+ *
+ * With a writer, every instruction is also recorded in the binary trace.
+ * The text trace is still written according to 'trace_level_', so it
+ * is usually turned off at the same time. NULL stops the binary trace.
+**/
+void Interpreter::SetTraceWriter(TraceWriter* writer) {
+  trace_writer_ = writer;
+}
+
+/******************************************************************************
+ * Mutator for the size of 'flight_recorder_', the number of instructions
+ * that are shown if the run crashes or times out. 0 turns it off.
+**/
+void Interpreter::SetFlightRecorderSize(int size) {
+  flight_recorder_.SetSize(size);
+}
+
+/******************************************************************************
+ * Mutator for 'cache_', which is told of every memory access so it can
+ * count hits and misses. NULL turns the simulation off.
+**/
+void Interpreter::SetCache(Cache* cache) {
+  cache_ = cache;
+}
+
+/******************************************************************************
+ * Mutator for 'cost_model_', which charges every instruction executed
+ * its simulated cycles. NULL turns the charging off.
+**/
+void Interpreter::SetCostModel(CostModel* cost_model) {
+  cost_model_ = cost_model;
+}
+
+/******************************************************************************
+ * Mutator for 'profiler_', which counts every instruction executed and
+ * the way every branch goes. NULL turns the counting off.
+**/
+void Interpreter::SetProfiler(Profiler* profiler) {
+  profiler_ = profiler;
+}
+
 /******************************************************************************
  * General functions.
 **/
 
+/******************************************************************************
+ * Function 'Crash'.
+ * The program being interpreted has crashed. The reason has already been
+ * logged, so all we do is make sure the log is written out and abandon the
+ * instruction; 'Step' catches this and stops the machine.
+**/
+void Interpreter::Crash() {
+  LogSink* sink = dynamic_cast<LogSink*>(log_stream_);
+  if (sink != NULL) {
+    sink->Flush();
+  } else {
+    log_stream_->flush();
+  }
+  is_faulted_ = true;
+  throw MachineFault();
+}
+
+/******************************************************************************
+ * Function 'Disassemble'.
+ * Format one word of memory as an instruction, for example 'LD  * 12' for
+ * an indirect load through location 12.
+ *
+ * Parameter:
+ *   word - the 16 bit word
+ *
+ * Returns:
+ *   the instruction as a 'string'
+**/
+string Interpreter::Disassemble(int word) {
+  static const string kMnemonics[] = { "BAN", "SUB", "STC", "AND",
+                                       "ADD", "LD ", "BR " };
+  int opcode = (word >> 13) & 7;
+  int target = word & 4095;
+
+  string s = "";
+  if (opcode == 7) {
+    if (target == 1) s = "RD ";
+    else if (target == 2) s = "STP";
+    else if (target == 3) s = "WRT";
+    else s = "???";
+  } else {
+    s = kMnemonics[opcode];
+    s += ((word >> 12) & 1) ? " * " : "   ";
+    s += Utils::Format(target);
+  }
+  return s;
+}
+
+/******************************************************************************
+ * Function 'DumpFlightRecorder'.
+ * Write the last instructions that were run, from the flight recorder,
+ * in the form of the instruction trace, and then the machine as it is now.
+ * This is for when a run has crashed or timed out, and does nothing if the
+ * flight recorder is off.
+**/
+void Interpreter::DumpFlightRecorder() {
+  if (!flight_recorder_.IsOn()) {
+    return;
+  }
+
+  vector<TraceRecord> records = flight_recorder_.GetRecords();
+  *log_stream_ << "FLIGHT RECORDER: LAST " << records.size()
+               << " INSTRUCTIONS" << endl;
+
+  TraceDecoder decoder;
+  for (auto iter = records.begin(); iter != records.end(); ++iter) {
+    decoder.WriteRecord(*iter, *log_stream_);
+    if (!(iter->flags & TraceRecord::kFaulted)) {
+      *log_stream_ << endl;
+    }
+  }
+  this->LogState();
+}
+
 /******************************************************************************
  * Function 'DoADD'.
  * This top level function interprets the 'ADD' opcode.
@@ -57,23 +312,29 @@ Interpreter::~Interpreter() {
 **/
 void Interpreter::DoADD(string addr, string target) {
 #ifdef EBUG
-  Utils::log_stream << "enter DoADD\n"; 
+  *log_stream_ << "enter DoADD\n"; 
 #endif
 
-  Utils::log_stream << "EXECUTE:    OPCODE ADDR TARGET " << "ADD        " 
-                    << addr << " " << target << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteExecute(*log_stream_, 4, addr, target);
+  }
 
   int location = this->GetTargetLocation("ADD FROM", addr, target);
-  int valuetoadd = globals_.BitStringToDec(memory_.at(location));
-  int twoscomplement = this->TwosComplementInteger(valuetoadd);
-  Utils::log_stream << "ADD VALUE " << memory_.at(location) 
-                    << " " << twoscomplement << endl;
-  Utils::log_stream << endl;
+  if (cache_ != NULL) {
+    cache_->Read(pc_, location);
+  }
+  int valuetoadd = this->ReadMemory(location);
+  if (trace_level_ >= kTraceInstructions) {
+    int twoscomplement = this->TwosComplementInteger(valuetoadd);
+    char bits[Utils::kFormatBufferSize];
+    globals_.DecToBitString(valuetoadd, 16, bits);
+    LogFormat::WriteValue(*log_stream_, 4, bits, twoscomplement);
+  }
 
   accum_ = (accum_ + valuetoadd) % 65536;
 
 #ifdef EBUG
-  Utils::log_stream << "leave DoADD\n"; 
+  *log_stream_ << "leave DoADD\n"; 
 #endif
 }
 
@@ -86,19 +347,26 @@ void Interpreter::DoADD(string addr, string target) {
 **/
 void Interpreter::DoAND(string addr, string target) {
 #ifdef EBUG
-  Utils::log_stream << "enter DoAND\n"; 
+  *log_stream_ << "enter DoAND\n"; 
 #endif
-  Utils::log_stream << "EXECUTE:    OPCODE ADDR TARGET " << "AND "
-                    << addr << " " << target << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteExecute(*log_stream_, 3, addr, target);
+  }
   int location = this->GetTargetLocation("AND WITH", addr, target);
-  int valuetoand = globals_.BitStringToDec(memory_.at(location));
-  Utils::log_stream << "AND VALUE " << memory_.at(location) << endl; 
-  Utils::log_stream << endl;
+  if (cache_ != NULL) {
+    cache_->Read(pc_, location);
+  }
+  int valuetoand = this->ReadMemory(location);
+  if (trace_level_ >= kTraceInstructions) {
+    char bits[Utils::kFormatBufferSize];
+    globals_.DecToBitString(valuetoand, 16, bits);
+    LogFormat::WriteValue(*log_stream_, 3, bits, 0);
+  }
 
   accum_ = accum_ & valuetoand;
 
 #ifdef EBUG
-  Utils::log_stream << "leave DoAND\n"; 
+  *log_stream_ << "leave DoAND\n"; 
 #endif
 }
 
@@ -111,10 +379,11 @@ void Interpreter::DoAND(string addr, string target) {
 **/
 void Interpreter::DoBAN(string addr, string target) {
 #ifdef EBUG
-  Utils::log_stream << "enter DoBAN\n"; 
+  *log_stream_ << "enter DoBAN\n"; 
 #endif
-  Utils::log_stream << "OPCODE ADDR TARGET " << "BAN " << addr << " " 
-                    << target << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteExecute(*log_stream_, 0, addr, target);
+  }
 
   // We are faking the twos-complement, so the 16 bit twos-complement
   // accumulator is negative if the high bit is set, which means as an
@@ -127,7 +396,7 @@ void Interpreter::DoBAN(string addr, string target) {
   }
 
 #ifdef EBUG
-  Utils::log_stream << "leave DoBAN\n"; 
+  *log_stream_ << "leave DoBAN\n"; 
 #endif
 }
 
@@ -139,17 +408,18 @@ void Interpreter::DoBAN(string addr, string target) {
 **/
 void Interpreter::DoBR(string addr, string target) {
 #ifdef EBUG
-  Utils::log_stream << "enter DoBR\n"; 
+  *log_stream_ << "enter DoBR\n"; 
 #endif
-  Utils::log_stream << "OPCODE ADDR TARGET " << "BR  " << addr << " " 
-                    << target << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteExecute(*log_stream_, 6, addr, target);
+  }
 
   int location = this->GetTargetLocation("BRANCH TO", addr, target);
 
     pc_ = location - 1; // a hack because we always increment later
 
 #ifdef EBUG
-  Utils::log_stream << "leave DoBR\n"; 
+  *log_stream_ << "leave DoBR\n"; 
 #endif
 }
 
@@ -161,21 +431,26 @@ void Interpreter::DoBR(string addr, string target) {
 **/
 void Interpreter::DoLD(string addr, string target) {
 #ifdef EBUG
-  Utils::log_stream << "enter DoLD\n"; 
+  *log_stream_ << "enter DoLD\n"; 
 #endif
-  Utils::log_stream << "EXECUTE:    OPCODE ADDR TARGET " << "LD         " 
-                    << addr << " " << target << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteExecute(*log_stream_, 5, addr, target);
+  }
 
   int location = this->GetTargetLocation("LOAD FROM", addr, target);
-  int loadvalue = globals_.BitStringToDec(memory_.at(location));
-  int twoscomplement = this->TwosComplementInteger(loadvalue);
-  Utils::log_stream << "LOAD VALUE " << twoscomplement << endl;
-  Utils::log_stream << endl;
+  if (cache_ != NULL) {
+    cache_->Read(pc_, location);
+  }
+  int loadvalue = this->ReadMemory(location);
+  if (trace_level_ >= kTraceInstructions) {
+    int twoscomplement = this->TwosComplementInteger(loadvalue);
+    LogFormat::WriteValue(*log_stream_, 5, "", twoscomplement);
+  }
 
   accum_ = loadvalue;
 
 #ifdef EBUG
-  Utils::log_stream << "leave DoLD\n"; 
+  *log_stream_ << "leave DoLD\n"; 
 #endif
 }
 
@@ -192,29 +467,64 @@ void Interpreter::DoLD(string addr, string target) {
 **/
 void Interpreter::DoRD(Scanner& data_scanner) {
 #ifdef EBUG
-  Utils::log_stream << "enter DoRD\n"; 
+  *log_stream_ << "enter DoRD\n"; 
 #endif
-  Utils::log_stream << "OPCODE " << "RD  " << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteSystem(*log_stream_, LogFormat::kRD);
+  }
 
-  if (data_scanner.HasNext()) {
+  if (is_replaying_input_) {
+    // Re-executing from a checkpoint or a replay file, so the values come
+    // from the log, and they must be read at the same instructions.
+    if (input_count_ < static_cast<int>(input_log_.size())) {
+      const InputRecord& record = input_log_.at(input_count_);
+      if (record.instruction_index != instruction_count_) {
+        *log_stream_ << "\nERROR -- REPLAY DIVERGES AT INSTRUCTION "
+                     << instruction_count_ << endl;
+        *log_stream_ << "PROGRAM TERMINATING" << endl;
+        this->Crash();
+      }
+      accum_ = record.value;
+      ++input_count_;
+    } else if (invalid_input_ != "") {
+      *log_stream_ << "\nERROR -- INVALID INPUT " << invalid_input_
+                   << endl;
+      *log_stream_ << "PROGRAM TERMINATING" << endl;
+      this->Crash();
+    } else {
+      *log_stream_ << "\nERROR -- READ PAST END OF FILE" << endl;
+      *log_stream_ << "PROGRAM TERMINATING" << endl;
+      this->Crash();
+    }
+  } else if (data_scanner.HasNext()) {
     string inputstring = data_scanner.Next();
     Hex hex = Hex(inputstring, globals_);
 
     if (hex.HasAnError()) {
-      Utils::log_stream << "\nERROR -- INVALID INPUT " << hex.ToString() << endl;
-      Utils::log_stream << "PROGRAM TERMINATING" << endl;
-      exit(0);
+      if (is_recording_) {
+        invalid_input_ = hex.ToString();
+      }
+      *log_stream_ << "\nERROR -- INVALID INPUT " << hex.ToString() << endl;
+      *log_stream_ << "PROGRAM TERMINATING" << endl;
+      this->Crash();
     } else {
       accum_ = hex.GetValue();
+      if (is_recording_) {
+        InputRecord record;
+        record.instruction_index = instruction_count_;
+        record.value = accum_;
+        input_log_.push_back(record);
+      }
+      ++input_count_;
     }
   } else {
-    Utils::log_stream << "\nERROR -- READ PAST END OF FILE" << endl;
-    Utils::log_stream << "PROGRAM TERMINATING" << endl;
-    exit(0);
+    *log_stream_ << "\nERROR -- READ PAST END OF FILE" << endl;
+    *log_stream_ << "PROGRAM TERMINATING" << endl;
+    this->Crash();
   }
 
 #ifdef EBUG
-  Utils::log_stream << "leave DoRD\n"; 
+  *log_stream_ << "leave DoRD\n"; 
 #endif
 }
 
@@ -231,23 +541,29 @@ void Interpreter::DoRD(Scanner& data_scanner) {
 **/
 void Interpreter::DoSTC(string addr, string target) {
 #ifdef EBUG
-  Utils::log_stream << "enter DoSTC\n"; 
+  *log_stream_ << "enter DoSTC\n"; 
 #endif
-  Utils::log_stream << "EXECUTE:    OPCODE ADDR TARGET " << "STC        " 
-                    << addr << " " << target << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteExecute(*log_stream_, 2, addr, target);
+  }
 
   int location = this->GetTargetLocation("STORE TO", addr, target);
-  string storevalue = globals_.DecToBitString(accum_, 16);
-  // We can use 'at' here because the 'GetTargetLocation' will have
-  // crashed if 'location' isn't a valid address.
-  memory_.at(location) = storevalue;
-  Utils::log_stream << "STORE VALUE " << storevalue << endl;
-  Utils::log_stream << endl;
+  // 'GetTargetLocation' will have crashed if 'location' isn't a valid
+  // address.
+  if (cache_ != NULL) {
+    cache_->Write(pc_, location);
+  }
+  this->WriteMemory(location, accum_);
+  if (trace_level_ >= kTraceInstructions) {
+    char bits[Utils::kFormatBufferSize];
+    globals_.DecToBitString(accum_, 16, bits);
+    LogFormat::WriteValue(*log_stream_, 2, bits, 0);
+  }
 
   accum_ = 0;
 
 #ifdef EBUG
-  Utils::log_stream << "leave DoSTC\n"; 
+  *log_stream_ << "leave DoSTC\n"; 
 #endif
 }
 
@@ -261,14 +577,16 @@ void Interpreter::DoSTC(string addr, string target) {
 **/
 void Interpreter::DoSTP() {
 #ifdef EBUG
-  Utils::log_stream << "enter DoSTP\n"; 
+  *log_stream_ << "enter DoSTP\n"; 
 #endif
-  Utils::log_stream << "OPCODE " << "STP " << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteSystem(*log_stream_, LogFormat::kSTP);
+  }
 
   pc_ = kPCForStop;
 
 #ifdef EBUG
-  Utils::log_stream << "leave DoSTP\n"; 
+  *log_stream_ << "leave DoSTP\n"; 
 #endif
 }
 
@@ -278,23 +596,29 @@ void Interpreter::DoSTP() {
 **/
 void Interpreter::DoSUB(string addr, string target) {
 #ifdef EBUG
-  Utils::log_stream << "enter DoSUB\n"; 
+  *log_stream_ << "enter DoSUB\n"; 
 #endif
 
-  Utils::log_stream << "EXECUTE:    OPCODE ADDR TARGET " << "SUB        " 
-                    << addr << " " << target << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteExecute(*log_stream_, 1, addr, target);
+  }
 
   int location = this->GetTargetLocation("SUB FROM", addr, target);
-  int valuetosub = globals_.BitStringToDec(memory_.at(location));
-  int twoscomplement = this->TwosComplementInteger(valuetosub);
-  Utils::log_stream << "SUB VALUE " << memory_.at(location) 
-                    << " " << twoscomplement << endl;
-  Utils::log_stream << endl;
+  if (cache_ != NULL) {
+    cache_->Read(pc_, location);
+  }
+  int valuetosub = this->ReadMemory(location);
+  if (trace_level_ >= kTraceInstructions) {
+    int twoscomplement = this->TwosComplementInteger(valuetosub);
+    char bits[Utils::kFormatBufferSize];
+    globals_.DecToBitString(valuetosub, 16, bits);
+    LogFormat::WriteValue(*log_stream_, 1, bits, twoscomplement);
+  }
 
   accum_ = (accum_ - valuetosub + 65536) % 65536;
 
 #ifdef EBUG
-  Utils::log_stream << "leave DoSUB\n"; 
+  *log_stream_ << "leave DoSUB\n"; 
 #endif
 }
 
@@ -308,22 +632,28 @@ void Interpreter::DoSUB(string addr, string target) {
  * Note that we actually write more than just the value itself so we can do
  * better tracing. This could/should be fixed in a final version of this code.
 **/
-void Interpreter::DoWRT(ofstream& out_stream) {
+void Interpreter::DoWRT(ostream& out_stream) {
 #ifdef EBUG
-  Utils::log_stream << "enter DoWRT\n"; 
+  *log_stream_ << "enter DoWRT\n"; 
 #endif
-  Utils::log_stream << "EXECUTE:    OPCODE             " << "WRT" << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteSystem(*log_stream_, LogFormat::kWRT);
+  }
 
-  string s = "WRITE OUTPUT ";
-  int twoscomplement = this->TwosComplementInteger(accum_);
-  s += Utils::Format(twoscomplement, 8) + " " + globals_.DecToBitString(accum_, 16);
+  // The line is put together in a buffer, since it goes to both streams.
+  char bits[Utils::kFormatBufferSize];
+  globals_.DecToBitString(accum_, 16, bits);
+  char s[64];
+  LogFormat::OutputInto(s, this->TwosComplementInteger(accum_), bits);
 
-  Utils::log_stream << s << endl;
+  if (trace_level_ >= kTraceInstructions) {
+    *log_stream_ << s << endl;
+  }
 
   out_stream << s << endl;
 
 #ifdef EBUG
-  Utils::log_stream << "leave DoWRT\n"; 
+  *log_stream_ << "leave DoWRT\n"; 
 #endif
 }
 
@@ -341,59 +671,98 @@ void Interpreter::DoWRT(ofstream& out_stream) {
  *   execute the instruction
  *   check for invalid PC or infinite loop
 **/
-void Interpreter::Interpret(Scanner& data_scanner, ofstream& out_stream) {
+void Interpreter::Interpret(Scanner& data_scanner, ostream& out_stream) {
 #ifdef EBUG
-  Utils::log_stream << "enter Interpret\n"; 
+  *log_stream_ << "enter Interpret\n"; 
 #endif
+  ScopedTimer timer("interpret");
 
-  ////////////////////////////////////////////////////////////////////////////
-  // Loop through the memory.
-  // Unpack the instruction.
-  // Execute the instruction.
-  //
-  // The only gotcha in this program is that we ALWAYS bump the PC by 1 at
-  // the bottom of this loop, so the execute function takes this into account
-  // and bumps by one too few.
-  int instructioncount = 0;
+  // A recording's checkpoints are at multiples of the interval from here,
+  // which is where 'SeekTo' looks for them.
+  instruction_count_ = 0;
+  next_checkpoint_ = 0;
   pc_ = 0;
-  while (true) { // run forever, break below for STP or instructioncount
-    string line = memory_.at(pc_);
-    string opcode = line.substr(0, 3);
-    string addr = line.substr(3, 1);
-    string target = line.substr(4);
-    Utils::log_stream << "INTERPRET: PC OPCODE ADDR TARGET " 
-                      << Utils::Format(pc_, 6) << " " << opcode 
-                      << " " << addr << " " << target << endl;
-    this->Execute(opcode, addr, target, data_scanner, out_stream);
+  this->Run(data_scanner, out_stream, max_instructions_);
 
-    // If we have hit the stop we will have returned a flag value that says
-    // we should stop execution. Note that if we happen to want to branch
-    // to an invalid location that is exactly the same as the 'kPCForStop'
-    // value we will already have crashed in the 'BR' or 'BAN' instruction
-    // before we get here.
-    if (pc_ == kPCForStop) {
-      break;
-    }
+#ifdef EBUG
+  *log_stream_ << "leave Interpret\n"; 
+#endif
+}
 
-    ++pc_;
-    // If we have executed but the PC is now incremented past the end of
-    // memory, we have an execution error.
-    if (pc_ >= memory_.size()) {
-      Utils::log_stream << "***** ERROR -- PC BEYOND MEMORY BOUND" << endl;
-      break;
+/******************************************************************************
+ * Function 'InterpretCores'.
+ * This top level function interprets the code on several cores that share
+ * the one memory.
+ *
+ * Each core has its own PC and accumulator. Every core starts at PC 0 with
+ * its core number in the accumulator, so that core 0 starts exactly as the
+ * single machine of 'Interpret' does and the program can tell the cores
+ * apart. A core stops on STP, on running past memory, or on timing out,
+ * and the machine stops when all of its cores have stopped.
+ *
+ * A core runs 'quantum' instructions at a turn. If 'deterministic' is true
+ * the cores take their turns in round robin order, all on this thread, so
+ * that every run of a program interleaves its cores the same way and a
+ * turn costs no more than a function call. Otherwise each core is run by
+ * its own host thread, which holds the machine for its turn, and the host
+ * decides which waiting thread gets the machine next.
+ *
+ * The opcodes share the trace, the log, and the hooks of the machine, so
+ * only one core executes at a time either way. This mode is for guest
+ * programs of several cores and for interleavings, not for measuring how
+ * the interpreter scales across host cores.
+ *
+ * Parameters:
+ *   data_scanner - the 'Scanner', needed for the 'RD' instruction
+ *   out_stream - the output stream , needed for the 'WRT' instruction
+ *   how_many_cores - the number of cores
+ *   quantum - the number of instructions a core runs in one turn
+ *   deterministic - take turns in round robin order or not
+**/
+void Interpreter::InterpretCores(Scanner& data_scanner, ostream& out_stream,
+                                 int how_many_cores, int quantum,
+                                 bool deterministic) {
+#ifdef EBUG
+  *log_stream_ << "enter InterpretCores\n"; 
+#endif
+  ScopedTimer timer("interpret");
+
+  cores_.clear();
+  for (int core = 0; core < how_many_cores; ++core) {
+    CoreState state;
+    state.pc = 0;
+    state.accum = core;
+    state.instruction_count = 0;
+    state.is_stopped = false;
+    cores_.push_back(state);
+  }
+  instruction_count_ = 0;
+
+  if (deterministic) {
+    int how_many_running = how_many_cores;
+    for (int core = 0; how_many_running > 0;
+         core = (core + 1) % how_many_cores) {
+      if (!cores_.at(core).is_stopped) {
+        this->RunQuantum(core, data_scanner, out_stream, quantum);
+        if (cores_.at(core).is_stopped) {
+          --how_many_running;
+        }
+      }
     }
-
-    // This is an interpreter thing. We prevent infinite loops from being
-    // interpreted by having a timeout feature on instruction count.
-    ++instructioncount;
-    if (instructioncount >= kMaxInstrCount) {
-      Utils::log_stream << "PROGRAM TIMED OUT" << endl;
-      break;
+  } else {
+    vector<thread> threads;
+    for (int core = 0; core < how_many_cores; ++core) {
+      threads.push_back(thread(&Interpreter::RunCore, this, core,
+                               std::ref(data_scanner), std::ref(out_stream),
+                               quantum));
     }
-  } // while (true)
+    for (auto iter = threads.begin(); iter != threads.end(); ++iter) {
+      iter->join();
+    }
+  }
 
 #ifdef EBUG
-  Utils::log_stream << "leave Interpret\n"; 
+  *log_stream_ << "leave InterpretCores\n"; 
 #endif
 }
 
@@ -411,9 +780,9 @@ void Interpreter::Interpret(Scanner& data_scanner, ofstream& out_stream) {
  *   out_stream - the output stream , needed for the 'WRT' instruction
 **/
 void Interpreter::Execute(string opcode, string addr, string target,
-                       Scanner& data_scanner, ofstream& out_stream) {
+                       Scanner& data_scanner, ostream& out_stream) {
 #ifdef EBUG
-  Utils::log_stream << "enter Execute\n"; 
+  *log_stream_ << "enter Execute\n"; 
 #endif
 
   if (opcode == "000") {
@@ -438,29 +807,33 @@ void Interpreter::Execute(string opcode, string addr, string target,
     } else if (target == "000000000011") {
       this->DoWRT(out_stream);
     } else {
-      Utils::log_stream << "***** ERROR -- ILLEGAL OPCODE " << opcode
-                        << " AND TARGET " << target << endl;
-      Utils::log_stream << "PROGRAM TERMINATING" << endl;
-      exit(0);
+      *log_stream_ << "***** ERROR -- ILLEGAL OPCODE " << opcode
+                   << " AND TARGET " << target << endl;
+      *log_stream_ << "PROGRAM TERMINATING" << endl;
+      this->Crash();
     }
   } else {
-    Utils::log_stream << "***** ERROR -- ILLEGAL OPCODE " << opcode
-                      << " AND TARGET " << target << endl;
-    Utils::log_stream << "PROGRAM TERMINATING" << endl;
-    exit(0);
+    *log_stream_ << "***** ERROR -- ILLEGAL OPCODE " << opcode
+                 << " AND TARGET " << target << endl;
+    *log_stream_ << "PROGRAM TERMINATING" << endl;
+    this->Crash();
   }
 
-  Utils::log_stream << "MACHINE IS NOW" << endl << this->ToString() << endl;
-  Utils::log_stream << endl;
+  if (trace_level_ >= kTraceFull) {
+    this->LogState();
+    *log_stream_ << endl;
+  } else if (trace_level_ >= kTraceInstructions) {
+    *log_stream_ << endl;
+  }
 
 #ifdef EBUG
-  Utils::log_stream << "leave Execute\n"; 
+  *log_stream_ << "leave Execute\n"; 
 #endif
 }
 
 /******************************************************************************
  * Function 'FlagAddressOutOfBounds'.
- * Check to see if an address is between 0 and 'kMaxMemory' inclusive and
+ * Check to see if an address is between 0 and 'kMaxMemory' exclusive and
  * die if this isn't the case.
  *
  * Parameter:
@@ -468,23 +841,62 @@ void Interpreter::Execute(string opcode, string addr, string target,
 **/
 void Interpreter::FlagAddressOutOfBounds(int address) {
 #ifdef EBUG
-  Utils::log_stream << "enter FlagAddressOutOfBounds\n"; 
+  *log_stream_ << "enter FlagAddressOutOfBounds\n"; 
 #endif
 
-  if ((address < 0) || (address > globals_.kMaxMemory)) {
+  if ((address < 0) || (address >= globals_.kMaxMemory)) {
     string s = "";
     s += "***** ERROR -- ADDRESS "; 
     s += Utils::Format(address, 8);
     s += " IS OUT OF BOUNDS"; 
-    Utils::log_stream << s << endl;
-    exit(0);
+    *log_stream_ << s << endl;
+    this->Crash();
   }
 
 #ifdef EBUG
-  Utils::log_stream << "leave FlagAddressOutOfBounds\n"; 
+  *log_stream_ << "leave FlagAddressOutOfBounds\n"; 
 #endif
 }
 
+/******************************************************************************
+ * Function 'FormatState'.
+ * Write the text of 'ToString' into 'state_text_'. This is done with the
+ * buffer formatting functions, and the buffer is kept from one call to
+ * the next, so a full trace allocates nothing for the dumps. The words
+ * of each line are taken straight from their page and expanded to bits
+ * by 'Utils::WordBitsInto', four at a time.
+ *
+ * Returns:
+ *   the number of chars of the text
+**/
+int Interpreter::FormatState() {
+  // Each line of the memory dump is "MEM nnnn-nnnn" and four words.
+  int how_many_lines = (memory_size_ + 3) / 4;
+  size_t how_many_chars = 64 + how_many_lines * LogFormat::kMemoryLineSize;
+  if (state_text_.size() < how_many_chars) {
+    state_text_.resize(how_many_chars);
+  }
+  char* s = &state_text_[0];
+  int length = 0;
+
+  char bits[Utils::kFormatBufferSize];
+  Utils::BitsInto(bits, accum_, 16);
+  length += LogFormat::StateHeadInto(s + length, pc_,
+                                     this->TwosComplementInteger(accum_), bits);
+
+  int memorysize = memory_size_;
+  for (int outersub = 0; outersub < memorysize; outersub += 4) {
+    // A line of four words never crosses a page.
+    const MemoryPage& page = *memory_pages_[outersub / kPageSize];
+    int how_many = min(4, memorysize - outersub);
+    length += LogFormat::MemoryLineInto(s + length, outersub,
+                                        &page[outersub % kPageSize],
+                                        how_many);
+  }
+
+  return length;
+}
+
 /******************************************************************************
  * Function 'GetTargetLocation'.
  * Get the target location, perhaps through indirect addressing.
@@ -497,32 +909,37 @@ void Interpreter::FlagAddressOutOfBounds(int address) {
  *   address - is this indirect or not?
  *   target - the target to look up
 **/
-int Interpreter::GetTargetLocation(string label, string address, string target) {
+int Interpreter::GetTargetLocation(string label, string address,
+                                   string target) {
 #ifdef EBUG
-  Utils::log_stream << "enter GetTargetLocation\n"; 
+  *log_stream_ << "enter GetTargetLocation\n"; 
 #endif
 
   int location = 0;
   if (address == "0") {
     location = globals_.BitStringToDec(target);
     this->FlagAddressOutOfBounds(location);
-    Utils::log_stream << endl;
-    Utils::log_stream << label << " LOCATION " << location << endl;
-    Utils::log_stream << endl;
+    if (trace_level_ >= kTraceInstructions) {
+      LogFormat::WriteLocation(*log_stream_, label, location, false, 0);
+    }
   } else {
     location = globals_.BitStringToDec(target);
     this->FlagAddressOutOfBounds(location);
-    int indirectlocation = globals_.BitStringToDec(memory_.at(location));
+    if (cache_ != NULL) {
+      cache_->Read(pc_, location);
+    }
+    int indirectlocation = this->ReadMemory(location);
     this->FlagAddressOutOfBounds(indirectlocation);
-    Utils::log_stream << endl;
-    Utils::log_stream << label << " LOCATION " << location << endl;
-    Utils::log_stream << label << " INDIRECT " << indirectlocation << endl;
-    Utils::log_stream << endl;
+    if (trace_level_ >= kTraceInstructions) {
+      LogFormat::WriteLocation(*log_stream_, label, location, true,
+                               indirectlocation);
+    }
     location = indirectlocation;
   }
+  last_location_ = location;
 
 #ifdef EBUG
-  Utils::log_stream << "leave GetTargetLocation\n"; 
+  *log_stream_ << "leave GetTargetLocation\n"; 
 #endif
 
   return location;
@@ -542,19 +959,24 @@ int Interpreter::GetTargetLocation(string label, string address, string target)
 **/
 void Interpreter::Load(Scanner& in_scanner, string binary_filename) {
 #ifdef EBUG
-  Utils::log_stream << "enter Load\n"; 
+  *log_stream_ << "enter Load\n"; 
 #endif
   globals_ = Globals();
   accum_ = 0;
   pc_ = 0;
+  input_count_ = 0;
   // Read the lines of the ASCII version of the executable and put the
   // ASCII into a 'vector' of 'string' data.
   //This is for homework 5, part 1 of 3
+  vector<string> lines;
   int linesub = 0;
-  while (in_scanner.HasNext()) {
-    string line = in_scanner.NextLine();
-    memory_.push_back(line);
-    ++linesub;
+  {
+    ScopedTimer timer("read text");
+    while (in_scanner.HasNext()) {
+      string line = in_scanner.NextLine();
+      lines.push_back(line);
+      ++linesub;
+    }
   }
   
   //Part 2 of homework 5
@@ -562,11 +984,14 @@ void Interpreter::Load(Scanner& in_scanner, string binary_filename) {
   //And push them onto a vector of shorts
 
   vector<short> short_vec;
-  for(int i = 0; i < memory_.size(); ++i){
-    string temp_string = memory_.at(i);
-    int temp_int = globals_.BitStringToDec(temp_string);
-    short temp_short = static_cast<short>(temp_int);
-    short_vec.push_back(temp_short);
+  {
+    ScopedTimer timer("parse");
+    for(UINT i = 0; i < lines.size(); ++i){
+      string temp_string = lines.at(i);
+      int temp_int = globals_.BitStringToDec(temp_string);
+      short temp_short = static_cast<short>(temp_int);
+      short_vec.push_back(temp_short);
+    }
   }
 
 
@@ -575,23 +1000,46 @@ void Interpreter::Load(Scanner& in_scanner, string binary_filename) {
   //I now need to write the vector of shorts
   //To a binary file
   FILE * fp;
-  fp = fopen("test.bin", "w");
-  for(auto iter = short_vec.begin(); iter != short_vec.end(); ++iter){
-    short n = *iter;
-    fwrite(&n, 2, 1, fp);
+  {
+    ScopedTimer timer("write binary");
+    fp = fopen("test.bin", "w");
+    for(auto iter = short_vec.begin(); iter != short_vec.end(); ++iter){
+      short n = *iter;
+      fwrite(&n, 2, 1, fp);
+    }
+    fclose(fp);
   }
-  fclose(fp);
 
+  // The memory is the full 4096 words of the machine, zero past the end
+  // of the executable, in pages that snapshots can share.
+  {
+    ScopedTimer timer("build memory");
+    memory_pages_.clear();
+    for (int page = 0; page < kHowManyPages; ++page) {
+      memory_pages_.push_back(make_shared<MemoryPage>(kPageSize, 0));
+    }
+    memory_size_ = short_vec.size();
+    image_hash_ = kHashBasis;
+    for (int address = 0; address < memory_size_; ++address) {
+      int word = static_cast<unsigned short>(short_vec.at(address));
+      this->WriteMemory(address, word);
+      image_hash_ = (image_hash_ ^ word) * kHashPrime;
+    }
+  }
 
   //I now need to read the binary I just wrote
   //This is for part 3 of assignment 5
   vector<string> check_values;
-  fp = fopen("test.bin", "r");
-
-  for(auto iter = short_vec.begin(); iter != short_vec.end(); ++iter){
-    short temp_short;
-    fread(&temp_short, 2, 1, fp);
-    check_values.push_back(globals_.DecToBitString(temp_short, 16));
+  {
+    ScopedTimer timer("check binary");
+    fp = fopen("test.bin", "r");
+
+    for(auto iter = short_vec.begin(); iter != short_vec.end(); ++iter){
+      short temp_short;
+      fread(&temp_short, 2, 1, fp);
+      check_values.push_back(globals_.DecToBitString(temp_short, 16));
+    }
+    fclose(fp);
   }
 
   /*
@@ -628,7 +1076,7 @@ void Interpreter::Load(Scanner& in_scanner, string binary_filename) {
     
 
 
-    Utils::log_stream << "Character is " << Utils::Format(character) 
+    *log_stream_ << "Character is " << Utils::Format(character) 
       << " is in ASCII: " << binary_str << endl;
     //Utilize the binary to decimal function
     //static cast back to character
@@ -640,13 +1088,582 @@ void Interpreter::Load(Scanner& in_scanner, string binary_filename) {
   //Write time to log_stream
   */
   
-  Utils::log_stream << "MACHINE IS NOW" << endl << this->ToString() << endl;
+  if (trace_level_ >= kTraceFull) {
+    this->LogState();
+  }
+
+#ifdef EBUG
+  *log_stream_ << "leave Load\n"; 
+#endif
+}
+
+/******************************************************************************
+ * Function 'LoadInputLog'.
+ * Read a replay file written by 'SaveInputLog' and replay it: from now on
+ * RD takes its values from the file instead of from the data 'Scanner'.
+ *
+ * Parameter:
+ *   filename - the name of the replay file
+ *
+ * Returns:
+ *   false if the file can't be read or is for a different executable
+**/
+bool Interpreter::LoadInputLog(string filename) {
+#ifdef EBUG
+  *log_stream_ << "enter LoadInputLog\n"; 
+#endif
+
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (fp == NULL) {
+    return false;
+  }
+
+  bool is_valid = true;
+  char magic[4];
+  LONG image_hash = 0;
+  LONG how_many = 0;
+  if ((fread(magic, 1, 4, fp) != 4) || (memcmp(magic, kReplayMagic, 4) != 0) ||
+      !Varint::Read(fp, image_hash) || !Varint::Read(fp, how_many) ||
+      (static_cast<UINT>(image_hash) != image_hash_)) {
+    is_valid = false;
+  }
+
+  input_log_.clear();
+  LONG instruction_index = 0;
+  for (LONG i = 0; is_valid && (i < how_many); ++i) {
+    LONG delta = 0;
+    int low = 0;
+    int high = 0;
+    if (!Varint::Read(fp, delta) || ((low = fgetc(fp)) == EOF) ||
+        ((high = fgetc(fp)) == EOF)) {
+      is_valid = false;
+      break;
+    }
+    instruction_index += delta;
+
+    InputRecord record;
+    record.instruction_index = instruction_index;
+    record.value = low | (high << 8);
+    input_log_.push_back(record);
+  }
+
+  LONG length = 0;
+  invalid_input_ = "";
+  if (is_valid && Varint::Read(fp, length)) {
+    for (LONG i = 0; i < length; ++i) {
+      int c = fgetc(fp);
+      if (c == EOF) {
+        is_valid = false;
+        break;
+      }
+      invalid_input_ += static_cast<char>(c);
+    }
+  } else {
+    is_valid = false;
+  }
+  fclose(fp);
+
+  is_replaying_input_ = is_valid;
+
+#ifdef EBUG
+  *log_stream_ << "leave LoadInputLog\n"; 
+#endif
+
+  return is_valid;
+}
+
+/******************************************************************************
+ * Function 'LogState'.
+ * Write "MACHINE IS NOW" and the text of 'ToString' to the log.
+**/
+void Interpreter::LogState() {
+  *log_stream_ << "MACHINE IS NOW" << endl;
+#ifdef EBUG
+  *log_stream_ << "enter ToString\n"; 
+#endif
+  int length = this->FormatState();
+#ifdef EBUG
+  *log_stream_ << "leave ToString\n"; 
+#endif
+  log_stream_->write(&state_text_[0], length);
+  *log_stream_ << endl;
+}
+
+/******************************************************************************
+ * Function 'ReadMemory'.
+ * Return the word at an address that is known to be in bounds.
+**/
+int Interpreter::ReadMemory(int address) const {
+  return (*memory_pages_[address / kPageSize])[address % kPageSize];
+}
+
+/******************************************************************************
+ * Function 'RestoreSnapshot'.
+ * Put the machine back into the state it was in when a snapshot was taken.
+ *
+ * Restoring shares the pages of the snapshot, just as taking it did, so
+ * this costs only the copy of the page table. The snapshot itself is not
+ * changed by anything the machine does afterwards and can be restored
+ * again and again.
+ *
+ * The data for RD is not part of the machine. The caller supplies the
+ * 'Scanner' for the instructions that follow, positioned after the first
+ * 'GetInputCount' values of the data or at the start of a new tail.
+ *
+ * Parameter:
+ *   snapshot - the snapshot to restore
+**/
+void Interpreter::RestoreSnapshot(const Snapshot& snapshot) {
+  pc_ = snapshot.pc;
+  accum_ = snapshot.accum;
+  instruction_count_ = snapshot.instruction_count;
+  input_count_ = snapshot.input_count;
+  memory_size_ = snapshot.memory_size;
+  memory_pages_ = snapshot.memory_pages;
+}
+
+/******************************************************************************
+ * Function 'Run'.
+ * Run the machine from its current state.
+ *
+ * We run a loop until we either hit the bogus PC value for the STP, we
+ * encounter an error, which can include having the PC go past the end of
+ * the executable, we time out, or we have executed 'stop_count'
+ * instructions in all.
+ *
+ * Parameters:
+ *   data_scanner - the 'Scanner', needed for the 'RD' instruction
+ *   out_stream - the output stream , needed for the 'WRT' instruction
+ *   stop_count - the instruction count at which to pause
+ *
+ * Returns:
+ *   true if we paused at 'stop_count', false if the machine has stopped
+**/
+bool Interpreter::Run(Scanner& data_scanner, ostream& out_stream,
+                      int stop_count) {
+  while (instruction_count_ < stop_count) {
+    if (is_recording_ && (checkpoint_interval_ > 0) &&
+        (instruction_count_ == next_checkpoint_)) {
+      if (checkpoints_.size() >= static_cast<UINT>(kMaxCheckpoints)) {
+        this->ThinCheckpoints();
+      }
+      checkpoints_.push_back(this->TakeSnapshot());
+      next_checkpoint_ += checkpoint_interval_;
+    }
+
+    if (!this->Step(data_scanner, out_stream)) {
+      return false;
+    }
+
+    // This is an interpreter thing. We prevent infinite loops from being
+    // interpreted by having a timeout feature on instruction count.
+    ++instruction_count_;
+    if (instruction_count_ >= max_instructions_) {
+      *log_stream_ << "PROGRAM TIMED OUT" << endl;
+      this->DumpFlightRecorder();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/******************************************************************************
+ * Function 'RunCore'.
+ * This is the body of the host thread for one core of 'InterpretCores'
+ * when the host decides the order of the cores. The machine mutex is held
+ * for each turn and let go between turns, so that another thread can get
+ * it.
+ *
+ * Parameters:
+ *   core - the number of this core
+ *   data_scanner - the 'Scanner', needed for the 'RD' instruction
+ *   out_stream - the output stream , needed for the 'WRT' instruction
+ *   quantum - the number of instructions a core runs in one turn
+**/
+void Interpreter::RunCore(int core, Scanner& data_scanner,
+                          ostream& out_stream, int quantum) {
+  ScopedTimer timer("core");
+  while (true) {
+    {
+      lock_guard<mutex> lock(machine_mutex_);
+      this->RunQuantum(core, data_scanner, out_stream, quantum);
+      if (cores_.at(core).is_stopped) {
+        break;
+      }
+    }
+    this_thread::yield();
+  }
+}
+
+/******************************************************************************
+ * Function 'RunQuantum'.
+ * Run one turn of a core of 'InterpretCores'.
+ *
+ * The core's PC and accumulator are swapped into 'pc_' and 'accum_' for
+ * its turn, so that the single-machine code for the opcodes is used
+ * unchanged. 'instruction_count_' counts the instructions of all of the
+ * cores, in the order they ran, so the trace records and the input log are
+ * numbered as for one machine. Each core times out on its own count.
+ *
+ * Parameters:
+ *   core - the number of this core
+ *   data_scanner - the 'Scanner', needed for the 'RD' instruction
+ *   out_stream - the output stream , needed for the 'WRT' instruction
+ *   quantum - the number of instructions a core runs in one turn
+**/
+void Interpreter::RunQuantum(int core, Scanner& data_scanner,
+                             ostream& out_stream, int quantum) {
+  CoreState& state = cores_.at(core);
+  pc_ = state.pc;
+  accum_ = state.accum;
+  if ((trace_level_ >= kTraceInstructions) && (cores_.size() > 1)) {
+    *log_stream_ << "CORE " << core << endl;
+  }
+
+  for (int count = 0; count < quantum; ++count) {
+    if (!this->Step(data_scanner, out_stream)) {
+      state.is_stopped = true;
+      break;
+    }
+    ++instruction_count_;
+    ++state.instruction_count;
+    if (state.instruction_count >= max_instructions_) {
+      *log_stream_ << "PROGRAM TIMED OUT" << endl;
+      this->DumpFlightRecorder();
+      state.is_stopped = true;
+      break;
+    }
+  }
+
+  state.pc = pc_;
+  state.accum = accum_;
+}
+
+/******************************************************************************
+ * Function 'TakeSnapshot'.
+ * Take a snapshot of the machine: PC, accumulator, memory, instruction
+ * count, and how much of the RD data has been read.
+ *
+ * The memory is not copied. The snapshot shares the pages of memory with
+ * the running machine, and 'WriteMemory' copies a shared page before it
+ * changes it, so the cost of a snapshot is the copy of the page table
+ * no matter how long the program has been running.
+ *
+ * Returns:
+ *   the snapshot
+**/
+Interpreter::Snapshot Interpreter::TakeSnapshot() const {
+  Snapshot snapshot;
+  snapshot.pc = pc_;
+  snapshot.accum = accum_;
+  snapshot.instruction_count = instruction_count_;
+  snapshot.input_count = input_count_;
+  snapshot.memory_size = memory_size_;
+  snapshot.memory_pages = memory_pages_;
+  return snapshot;
+}
+
+/******************************************************************************
+ * Function 'SaveInputLog'.
+ * Write the input recorded by 'StartRecording' to a replay file.
+ *
+ * The file holds everything that a run depends on that is not in the
+ * executable: every value RD read and the instruction at which it was
+ * read. It is binary and compact:
+ *   the four bytes "P16R"
+ *   a hash of the executable, so a replay of the wrong program is refused
+ *   the number of values
+ *   for each value, the change in instruction index since the previous
+ *     value and then the 16 bit value, low byte first
+ *   the length and then the text of the input that RD found invalid, if
+ *     the run ended that way, so a replay ends with the same error
+ * with the hash, the number, the changes, and the length as varints.
+ *
+ * Parameter:
+ *   filename - the name of the replay file
+ *
+ * Returns:
+ *   false if the file can't be written
+**/
+bool Interpreter::SaveInputLog(string filename) const {
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if (fp == NULL) {
+    return false;
+  }
+
+  fwrite(kReplayMagic, 1, 4, fp);
+  Varint::Write(fp, image_hash_);
+  Varint::Write(fp, input_log_.size());
+
+  int previous_index = 0;
+  for (auto iter = input_log_.begin(); iter != input_log_.end(); ++iter) {
+    Varint::Write(fp, iter->instruction_index - previous_index);
+    fputc(iter->value & 255, fp);
+    fputc((iter->value >> 8) & 255, fp);
+    previous_index = iter->instruction_index;
+  }
+  Varint::Write(fp, invalid_input_.size());
+  fwrite(invalid_input_.data(), 1, invalid_input_.size(), fp);
+
+  bool is_written = (ferror(fp) == 0);
+  fclose(fp);
+  return is_written;
+}
+
+/******************************************************************************
+ * Function 'SeekTo'.
+ * Put the machine into the state it was in after 'instruction_index'
+ * instructions of a recorded run, forward or backward from where it is.
+ *
+ * We restore the last checkpoint at or before the index and re-execute
+ * from there, quietly, taking the values for RD from the recorded input.
+ * Nothing is written to the log either, since the timeouts and the errors
+ * met on the way were logged when the run was recorded.
+ * This costs at most one checkpoint interval of instructions.
+ *
+ * Parameter:
+ *   instruction_index - the instruction count to go to; a negative one
+ *                       goes to the start of the run
+**/
+void Interpreter::SeekTo(int instruction_index) {
+#ifdef EBUG
+  *log_stream_ << "enter SeekTo\n"; 
+#endif
+
+  if (checkpoints_.empty()) {
+    return;
+  }
+  bool is_replaying_input = is_replaying_input_;
+  if (instruction_index < 0) {
+    instruction_index = 0;
+  }
+
+  UINT which = instruction_index / checkpoint_interval_;
+  if (which >= checkpoints_.size()) {
+    which = checkpoints_.size() - 1;
+  }
+  this->RestoreSnapshot(checkpoints_.at(which));
+  is_faulted_ = false;
+
+  int trace_level = trace_level_;
+  TraceWriter* trace_writer = trace_writer_;
+  Profiler* profiler = profiler_;
+  CostModel* cost_model = cost_model_;
+  Cache* cache = cache_;
+  int flight_recorder_size = flight_recorder_.GetSize();
+  bool is_recording = is_recording_;
+  ostream* log_stream = log_stream_;
+  ostream no_log_stream(NULL);
+  trace_level_ = kTraceNone;
+  trace_writer_ = NULL;
+  profiler_ = NULL;
+  cost_model_ = NULL;
+  cache_ = NULL;
+  flight_recorder_.SetSize(0);
+  is_recording_ = false;
+  is_replaying_input_ = true;
+  log_stream_ = &no_log_stream;
+
+  Scanner no_data_scanner;
+  ostream no_out_stream(NULL);
+  this->Run(no_data_scanner, no_out_stream, instruction_index);
+
+  trace_level_ = trace_level;
+  trace_writer_ = trace_writer;
+  profiler_ = profiler;
+  cost_model_ = cost_model;
+  cache_ = cache;
+  flight_recorder_.SetSize(flight_recorder_size);
+  is_recording_ = is_recording;
+  is_replaying_input_ = is_replaying_input;
+  log_stream_ = log_stream;
 
 #ifdef EBUG
-  Utils::log_stream << "leave Load\n"; 
+  *log_stream_ << "leave SeekTo\n"; 
 #endif
 }
 
+/******************************************************************************
+ * Function 'StartRecording'.
+ * Record the next run of 'Interpret' so that 'SeekTo' can go to any point
+ * in it, or so that it can be saved with 'SaveInputLog' and replayed.
+ *
+ * A recording is a checkpoint every 'checkpoint_interval' instructions
+ * and the values read by RD, which are the only thing the run depends on
+ * that is not in the machine. Since checkpoints share unchanged memory
+ * pages, recording adds little to the cost of a run. A long run would
+ * still pile up checkpoints without end, so there are never more than
+ * 'kMaxCheckpoints' of them; see 'ThinCheckpoints'.
+ *
+ * Parameter:
+ *   checkpoint_interval - the number of instructions between checkpoints,
+ *                         or 0 to record only the input
+**/
+void Interpreter::StartRecording(int checkpoint_interval) {
+  checkpoint_interval_ = (checkpoint_interval > 0) ? checkpoint_interval : 0;
+  checkpoints_.clear();
+  input_log_.clear();
+  invalid_input_ = "";
+  is_recording_ = true;
+}
+
+/******************************************************************************
+ * Function 'StopRecording'.
+ * Stop adding to the recording. The checkpoints and the recorded input are
+ * kept for 'SeekTo'.
+**/
+void Interpreter::StopRecording() {
+  is_recording_ = false;
+}
+
+/******************************************************************************
+ * Function 'Step'.
+ * Fetch, decode, and execute the one instruction pointed to by the PC.
+ *
+ * The only gotcha in this program is that we ALWAYS bump the PC by 1 after
+ * executing, so the execute function takes this into account and bumps by
+ * one too few.
+ *
+ * Parameters:
+ *   data_scanner - the 'Scanner', needed for the 'RD' instruction
+ *   out_stream - the output stream , needed for the 'WRT' instruction
+ *
+ * Returns:
+ *   false if the machine has stopped, true if it can go on
+**/
+bool Interpreter::Step(Scanner& data_scanner, ostream& out_stream) {
+  // Only an empty executable can start with the PC out of bounds.
+  if (pc_ >= memory_size_) {
+    *log_stream_ << "***** ERROR -- PC BEYOND MEMORY BOUND" << endl;
+    this->DumpFlightRecorder();
+    return false;
+  }
+
+  int word = this->ReadMemory(pc_);
+  if (cache_ != NULL) {
+    cache_->Fetch(pc_, word);
+  }
+  char line[Utils::kFormatBufferSize];
+  globals_.DecToBitString(word, 16, line);
+  string opcode(line, 3);
+  string addr(line + 3, 1);
+  string target(line + 4);
+  if (trace_level_ >= kTraceInstructions) {
+    LogFormat::WriteInterpret(*log_stream_, pc_, opcode, addr, target);
+  }
+
+  TraceRecord record;
+  bool is_tracing = (trace_writer_ != NULL) || flight_recorder_.IsOn();
+  if (is_tracing) {
+    record.instruction_index = instruction_count_;
+    record.accum_before = accum_;
+    record.pc = pc_;
+    record.word = word;
+    record.opcode = (word >> 13) & 7;
+    record.flags = ((word >> 12) & 1) ? TraceRecord::kIndirect : 0;
+  }
+
+  int this_pc = pc_;
+  if (profiler_ != NULL) {
+    profiler_->Count(this_pc, word);
+  }
+
+  // 'GetTargetLocation' sets this, so afterwards it says whether a branch
+  // was taken and where to.
+  last_location_ = -1;
+
+  try {
+    this->Execute(opcode, addr, target, data_scanner, out_stream);
+  } catch (const MachineFault&) {
+    if (is_tracing) {
+      record.accum_after = accum_;
+      record.address = TraceRecord::kNoAddress;
+      record.operand = 0;
+      record.flags |= TraceRecord::kFaulted;
+      if (trace_writer_ != NULL) {
+        trace_writer_->Append(record);
+      }
+      if (flight_recorder_.IsOn()) {
+        flight_recorder_.Append(record);
+        this->DumpFlightRecorder();
+      }
+    }
+    if (exit_on_fault_) {
+      if (trace_writer_ != NULL) {
+        trace_writer_->Close();
+      }
+      exit(0);
+    }
+    return false;
+  }
+
+  if ((profiler_ != NULL) && ((((word >> 13) & 7) == 0) ||
+                               (((word >> 13) & 7) == 6))) {
+    profiler_->CountBranch(this_pc, last_location_);
+  }
+  if (cost_model_ != NULL) {
+    cost_model_->Charge(word, last_location_ >= 0);
+  }
+
+  if (is_tracing) {
+    record.accum_after = accum_;
+    record.address = TraceRecord::kNoAddress;
+    record.operand = 0;
+    if (last_location_ >= 0) {
+      record.address = last_location_;
+      if ((record.opcode == 0) || (record.opcode == 6)) {
+        record.flags |= TraceRecord::kBranchTaken;
+      } else {
+        record.operand = this->ReadMemory(last_location_);
+      }
+    }
+    if (trace_writer_ != NULL) {
+      trace_writer_->Append(record);
+    }
+    if (flight_recorder_.IsOn()) {
+      flight_recorder_.Append(record);
+    }
+  }
+
+  // If we have hit the stop we will have returned a flag value that says
+  // we should stop execution. Note that if we happen to want to branch
+  // to an invalid location that is exactly the same as the 'kPCForStop'
+  // value we will already have crashed in the 'BR' or 'BAN' instruction
+  // before we get here.
+  if (pc_ == kPCForStop) {
+    return false;
+  }
+
+  ++pc_;
+  // If we have executed but the PC is now incremented past the end of
+  // memory, we have an execution error.
+  if (pc_ >= memory_size_) {
+    *log_stream_ << "***** ERROR -- PC BEYOND MEMORY BOUND" << endl;
+    this->DumpFlightRecorder();
+    return false;
+  }
+
+  return true;
+}
+
+/******************************************************************************
+ * Function 'ThinCheckpoints'.
+ * Drop every other checkpoint and double the interval between them, so
+ * that a recording of any length keeps at most 'kMaxCheckpoints'. The
+ * ones kept are still at multiples of the interval, which is where
+ * 'SeekTo' looks for them, and the next one is due where it was.
+**/
+void Interpreter::ThinCheckpoints() {
+  UINT kept = 0;
+  for (UINT which = 0; which < checkpoints_.size(); which += 2) {
+    checkpoints_.at(kept) = checkpoints_.at(which);
+    ++kept;
+  }
+  checkpoints_.resize(kept);
+  checkpoint_interval_ *= 2;
+}
+
 /******************************************************************************
  * Function 'ToString'.
  *
@@ -660,37 +1677,18 @@ void Interpreter::Load(Scanner& in_scanner, string binary_filename) {
 **/
 string Interpreter::ToString() {
 #ifdef EBUG
-  Utils::log_stream << "enter ToString\n"; 
+  *log_stream_ << "enter ToString\n"; 
 #endif
 
-  string s = "";
-
-  s += "PC    " + Utils::Format(pc_, 8) + "\n";
-  
-  int twoscomplement = this->TwosComplementInteger(accum_);
-  s += "ACCUM " + Utils::Format(twoscomplement, 8)
-                + " " + globals_.DecToBitString(accum_, 16)
-                + "\n\n";
-
-  int memorysize = memory_.size();
-  for (int outersub = 0; outersub < memorysize; outersub += 4) {
-    s += "MEM " + Utils::Format(outersub, 4)
-                + "-"
-                + Utils::Format(outersub+3, 4);
-    for (int innersub = outersub; innersub < outersub + 4; ++innersub) {
-      if (innersub < memorysize) {
-        s += " " + memory_.at(innersub);
-      }
-    }
-    s += "\n";
-  }
+  int length = this->FormatState();
 
 #ifdef EBUG
-  Utils::log_stream << "leave ToString\n"; 
+  *log_stream_ << "leave ToString\n"; 
 #endif
 
-  return s;
+  return string(&state_text_[0], length);
 }
+
 /******************************************************************************
  * Function 'TwosComplementInteger'.
  *
@@ -705,14 +1703,29 @@ string Interpreter::ToString() {
 **/
 int Interpreter::TwosComplementInteger(int what) {
 #ifdef EBUG
-  Utils::log_stream << "enter TwosComplementInteger\n"; 
+  *log_stream_ << "enter TwosComplementInteger\n"; 
 #endif
 
   int twoscomplement = (what > 32768) ? what - 65536 : what;
 
 #ifdef EBUG
-  Utils::log_stream << "leave TwosComplementInteger\n"; 
+  *log_stream_ << "leave TwosComplementInteger\n"; 
 #endif
 
   return twoscomplement;
 }
+
+/******************************************************************************
+ * Function 'WriteMemory'.
+ * Store a word at an address that is known to be in bounds.
+ *
+ * A page that is shared with a snapshot is copied before it is changed,
+ * so that the snapshot keeps the memory as it was.
+**/
+void Interpreter::WriteMemory(int address, int value) {
+  shared_ptr<MemoryPage>& page = memory_pages_[address / kPageSize];
+  if (!page.unique()) {
+    page = make_shared<MemoryPage>(*page);
+  }
+  (*page)[address % kPageSize] = value;
+}
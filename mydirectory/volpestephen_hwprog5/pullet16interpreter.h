@@ -11,38 +11,148 @@
 #define INTERPRETER_H
 #include <fstream>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 using namespace std;
 
 #include "../../Utilities/scanner.h"
 #include "../../Utilities/scanline.h"
+#include "../../Utilities/scopedtimer.h"
 #include "../../Utilities/utils.h"
 
 #include "globals.h"
 #include "hex.h"
+#include "pullet16cache.h"
+#include "pullet16costmodel.h"
+#include "pullet16logformat.h"
+#include "pullet16profiler.h"
+#include "pullet16trace.h"
+#include "pullet16tracedecoder.h"
 
 class Interpreter {
+  private:
+    static const int kPageSize = 64;
+    static const int kHowManyPages = Globals::kMaxMemory / kPageSize;
+
+    typedef vector<int> MemoryPage;
+
   public:
+    struct Snapshot {
+      int pc;
+      int accum;
+      int instruction_count;
+      int input_count;
+      int memory_size;
+      vector<shared_ptr<MemoryPage> > memory_pages;
+    };
+
+    static const int kTraceNone = 0;
+    static const int kTraceInstructions = 1;
+    static const int kTraceFull = 2;
+
     Interpreter();
     virtual ~Interpreter();
 
-    void Interpret(Scanner& data_scanner, ofstream& out_stream);
+    int GetAccum() const;
+    void SetExitOnFault(bool value);
+    bool IsFaulted() const;
+    int GetInputCount() const;
+    int GetInstructionCount() const;
+    ostream& GetLogStream() const;
+    void SetLogStream(ostream& log_stream);
+    int GetMaxInstructions() const;
+    void SetMaxInstructions(int how_many);
+    int GetMemorySize() const;
+    int GetMemoryWord(int address) const;
+    int GetPC() const;
+    int GetTraceLevel() const;
+    void SetTraceLevel(int level);
+    void SetTraceWriter(TraceWriter* writer);
+    void SetFlightRecorderSize(int size);
+    void SetCache(Cache* cache);
+    void SetCostModel(CostModel* cost_model);
+    void SetProfiler(Profiler* profiler);
+
+    static string Disassemble(int word);
+
+    void Interpret(Scanner& data_scanner, ostream& out_stream);
+    void InterpretCores(Scanner& data_scanner, ostream& out_stream,
+                        int how_many_cores, int quantum, bool deterministic);
     void Load(Scanner& exec_scanner, string binary_filename);
+    bool Run(Scanner& data_scanner, ostream& out_stream, int stop_count);
+
+    void RestoreSnapshot(const Snapshot& snapshot);
+    Snapshot TakeSnapshot() const;
+
+    bool LoadInputLog(string filename);
+    bool SaveInputLog(string filename) const;
+    void SeekTo(int instruction_index);
+    void StartRecording(int checkpoint_interval);
+    void StopRecording();
+
+    string ToString();
 
   private:
+    static const int kMaxCheckpoints = 4096;
     static const int kMaxInstrCount = 128;
     static const int kPCForStop = 7777;
 
+    struct MachineFault {
+    };
+
+    struct InputRecord {
+      int instruction_index;
+      int value;
+    };
+
+    struct CoreState {
+      int pc;
+      int accum;
+      int instruction_count;
+      bool is_stopped;
+    };
+
     int pc_;
     int accum_;
+    int input_count_;
+    int instruction_count_;
+    int max_instructions_;
+    int trace_level_;
+    TraceWriter* trace_writer_;
+    ostream* log_stream_;
+    FlightRecorder flight_recorder_;
+    Profiler* profiler_;
+    CostModel* cost_model_;
+    Cache* cache_;
+    int last_location_;
 
-    string ToString();
+    bool exit_on_fault_;
+    bool is_faulted_;
+
+    bool is_recording_;
+    bool is_replaying_input_;
+    int checkpoint_interval_;
+    int next_checkpoint_;
+    vector<Snapshot> checkpoints_;
+    vector<InputRecord> input_log_;
+    string invalid_input_;
+
+    vector<CoreState> cores_;
+    mutex machine_mutex_;
 
-    vector<string> memory_;
+    int memory_size_;
+    UINT image_hash_;
+    vector<shared_ptr<MemoryPage> > memory_pages_;
     Globals globals_;
+    vector<char> state_text_;
 
+    void Crash();
+    void DumpFlightRecorder();
     void DoADD(string addr, string target);
     void DoAND(string addr, string target);
     void DoBAN(string addr, string target);
@@ -52,11 +162,21 @@ class Interpreter {
     void DoSTC(string addr, string target);
     void DoSTP();
     void DoSUB(string addr, string target);
-    void DoWRT(ofstream& out_stream);
+    void DoWRT(ostream& out_stream);
     void Execute(string opcode, string addr, string target,
-                 Scanner& data_scanner, ofstream& out_stream);
+                 Scanner& data_scanner, ostream& out_stream);
     void FlagAddressOutOfBounds(int address);
+    int FormatState();
     int GetTargetLocation(string label, string address, string target);
+    void LogState();
+    int ReadMemory(int address) const;
+    void RunCore(int core, Scanner& data_scanner, ostream& out_stream,
+                 int quantum);
+    void RunQuantum(int core, Scanner& data_scanner, ostream& out_stream,
+                    int quantum);
+    bool Step(Scanner& data_scanner, ostream& out_stream);
+    void ThinCheckpoints();
     int TwosComplementInteger(int value);
+    void WriteMemory(int address, int value);
 };
 #endif
@@ -0,0 +1,218 @@
+#include "pullet16logformat.h"
+
+/******************************************************************************
+ *3456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
+ * Class 'LogFormat' for the text of the execution log.
+ *
+ * 'Interpreter' writes this text as it runs, and 'TraceDecoder' writes it
+ * again from the records of a binary trace, so the labels and spacing of
+ * every line are kept here and the two cannot drift apart.
+ *
+ * The callers convert the values to bits and to twos complement
+ * themselves, so that these functions only lay out the text.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+**/
+
+/******************************************************************************
+ * The start of the line for each of the opcodes 0 through 6, before the
+ * 'addr' and 'target' bits.
+**/
+static const char* const kExecuteText[] = {
+  "OPCODE ADDR TARGET BAN ",
+  "EXECUTE:    OPCODE ADDR TARGET SUB        ",
+  "EXECUTE:    OPCODE ADDR TARGET STC        ",
+  "EXECUTE:    OPCODE ADDR TARGET AND ",
+  "EXECUTE:    OPCODE ADDR TARGET ADD        ",
+  "EXECUTE:    OPCODE ADDR TARGET LD         ",
+  "OPCODE ADDR TARGET BR  "
+};
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'WriteInterpret'.
+ * Write the line that starts the text of every instruction.
+ *
+ * Parameters:
+ *   out_stream - where to write the line
+ *   pc - the address of the instruction
+ *   opcode - the three opcode bits
+ *   addr - the indirect bit
+ *   target - the twelve target bits
+**/
+void LogFormat::WriteInterpret(ostream& out_stream, int pc,
+                               const string& opcode, const string& addr,
+                               const string& target) {
+  char pc_text[Utils::kFormatBufferSize];
+  Utils::FormatInto(pc_text, pc, 6);
+  out_stream << "INTERPRET: PC OPCODE ADDR TARGET " << pc_text << " "
+             << opcode << " " << addr << " " << target << "\n";
+}
+
+/******************************************************************************
+ * Function 'WriteExecute'.
+ * Write the line naming one of the opcodes 0 through 6.
+ *
+ * Parameters:
+ *   out_stream - where to write the line
+ *   opcode - the opcode
+ *   addr - the indirect bit
+ *   target - the twelve target bits
+**/
+void LogFormat::WriteExecute(ostream& out_stream, int opcode,
+                             const string& addr, const string& target) {
+  out_stream << kExecuteText[opcode] << addr << " " << target << "\n";
+}
+
+/******************************************************************************
+ * Function 'WriteSystem'.
+ * Write the line naming one of the functions of opcode 7.
+ *
+ * Parameters:
+ *   out_stream - where to write the line
+ *   function - 'kRD', 'kSTP', or 'kWRT'
+**/
+void LogFormat::WriteSystem(ostream& out_stream, int function) {
+  if (function == kRD) {
+    out_stream << "OPCODE RD  \n";
+  } else if (function == kSTP) {
+    out_stream << "OPCODE STP \n";
+  } else if (function == kWRT) {
+    out_stream << "EXECUTE:    OPCODE             WRT\n";
+  }
+}
+
+/******************************************************************************
+ * Function 'WriteLocation'.
+ * Write the lines for the location an instruction uses, with the blank
+ * lines around them.
+ *
+ * Parameters:
+ *   out_stream - where to write the lines
+ *   label - the label for the location, such as 'LOAD FROM'
+ *   location - the target of the instruction
+ *   is_indirect - whether the target holds the location
+ *   indirect_location - the location held at the target, if indirect
+**/
+void LogFormat::WriteLocation(ostream& out_stream, const string& label,
+                              int location, bool is_indirect,
+                              int indirect_location) {
+  out_stream << "\n" << label << " LOCATION " << location << "\n";
+  if (is_indirect) {
+    out_stream << label << " INDIRECT " << indirect_location << "\n";
+  }
+  out_stream << "\n";
+}
+
+/******************************************************************************
+ * Function 'WriteValue'.
+ * Write the line for the value that one of the opcodes 1 through 5 used,
+ * and the blank line after it.
+ *
+ * Parameters:
+ *   out_stream - where to write the lines
+ *   opcode - the opcode
+ *   bits - the value as 16 bits
+ *   twoscomplement - the value as a twos complement integer
+**/
+void LogFormat::WriteValue(ostream& out_stream, int opcode, const char* bits,
+                           int twoscomplement) {
+  if (opcode == 1) {
+    out_stream << "SUB VALUE " << bits << " " << twoscomplement << "\n";
+  } else if (opcode == 2) {
+    out_stream << "STORE VALUE " << bits << "\n";
+  } else if (opcode == 3) {
+    out_stream << "AND VALUE " << bits << "\n";
+  } else if (opcode == 4) {
+    out_stream << "ADD VALUE " << bits << " " << twoscomplement << "\n";
+  } else if (opcode == 5) {
+    out_stream << "LOAD VALUE " << twoscomplement << "\n";
+  }
+  out_stream << "\n";
+}
+
+/******************************************************************************
+ * Function 'OutputInto'.
+ * Put the line that 'WRT' writes, without its newline, into a buffer.
+ *
+ * Parameters:
+ *   buffer - where to put the line, at least 64 chars
+ *   twoscomplement - the accumulator as a twos complement integer
+ *   bits - the accumulator as 16 bits
+ *
+ * Returns:
+ *   the number of chars of the line, which is also null terminated
+**/
+int LogFormat::OutputInto(char* buffer, int twoscomplement,
+                          const char* bits) {
+  int length = 0;
+  memcpy(buffer + length, "WRITE OUTPUT ", 13);
+  length += 13;
+  length += Utils::FormatInto(buffer + length, twoscomplement, 8);
+  buffer[length++] = ' ';
+  strcpy(buffer + length, bits);
+  return length + strlen(bits);
+}
+
+/******************************************************************************
+ * Function 'StateHeadInto'.
+ * Put the PC and accumulator lines of the machine dump into a buffer.
+ *
+ * Parameters:
+ *   buffer - where to put the lines, at least 64 chars
+ *   pc - the program counter
+ *   twoscomplement - the accumulator as a twos complement integer
+ *   bits - the accumulator as 16 bits
+ *
+ * Returns:
+ *   the number of chars of the lines
+**/
+int LogFormat::StateHeadInto(char* buffer, int pc, int twoscomplement,
+                             const char* bits) {
+  int length = 0;
+  memcpy(buffer + length, "PC    ", 6);
+  length += 6;
+  length += Utils::FormatInto(buffer + length, pc, 8);
+  buffer[length++] = '\n';
+
+  memcpy(buffer + length, "ACCUM ", 6);
+  length += 6;
+  length += Utils::FormatInto(buffer + length, twoscomplement, 8);
+  buffer[length++] = ' ';
+  int how_many_bits = strlen(bits);
+  memcpy(buffer + length, bits, how_many_bits);
+  length += how_many_bits;
+  buffer[length++] = '\n';
+  buffer[length++] = '\n';
+  return length;
+}
+
+/******************************************************************************
+ * Function 'MemoryLineInto'.
+ * Put one line of the memory dump into a buffer.
+ *
+ * Parameters:
+ *   buffer - where to put the line, at least 'kMemoryLineSize' chars
+ *   address - the address of the first word of the line
+ *   words - the words of the line
+ *   how_many - the number of words, at most four
+ *
+ * Returns:
+ *   the number of chars of the line, with its newline
+**/
+int LogFormat::MemoryLineInto(char* buffer, int address, const int* words,
+                              int how_many) {
+  int length = 0;
+  memcpy(buffer + length, "MEM ", 4);
+  length += 4;
+  length += Utils::FormatInto(buffer + length, address, 4);
+  buffer[length++] = '-';
+  length += Utils::FormatInto(buffer + length, address + 3, 4);
+  length += Utils::WordBitsInto(buffer + length, words, how_many);
+  buffer[length++] = '\n';
+  return length;
+}
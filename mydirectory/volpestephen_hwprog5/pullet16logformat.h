@@ -0,0 +1,47 @@
+/****************************************************************
+ * Header file for the text of the Pullet16 execution log.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+#ifndef LOGFORMAT_H
+#define LOGFORMAT_H
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+#include "../../Utilities/utils.h"
+
+class LogFormat {
+  public:
+    // The functions of opcode 7, by their target.
+    static const int kRD = 1;
+    static const int kSTP = 2;
+    static const int kWRT = 3;
+
+    // The most chars of one line of the memory dump, with its newline.
+    static const int kMemoryLineSize = 13 + 4 * 17 + 1;
+
+    static void WriteInterpret(ostream& out_stream, int pc,
+                               const string& opcode, const string& addr,
+                               const string& target);
+    static void WriteExecute(ostream& out_stream, int opcode,
+                             const string& addr, const string& target);
+    static void WriteSystem(ostream& out_stream, int function);
+    static void WriteLocation(ostream& out_stream, const string& label,
+                              int location, bool is_indirect,
+                              int indirect_location);
+    static void WriteValue(ostream& out_stream, int opcode, const char* bits,
+                           int twoscomplement);
+
+    static int OutputInto(char* buffer, int twoscomplement, const char* bits);
+    static int StateHeadInto(char* buffer, int pc, int twoscomplement,
+                             const char* bits);
+    static int MemoryLineInto(char* buffer, int address, const int* words,
+                              int how_many);
+};
+#endif
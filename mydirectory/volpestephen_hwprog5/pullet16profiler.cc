@@ -0,0 +1,232 @@
+#include "pullet16profiler.h"
+
+#include "pullet16interpreter.h"
+
+/******************************************************************************
+ *3456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
+ * Class 'Profiler' for counting where a Pullet16 program spends its time.
+ *
+ * The interpreter calls 'Count' for every instruction it executes and
+ * 'CountBranch' for every BAN and BR. The counts are plain arrays indexed
+ * by the PC, so the cost is a few increments per instruction and the
+ * profiler can be left on for a full run.
+ *
+ * After the run there are two outputs.
+ *
+ * 'WriteReport' gives the counts by opcode and then every PC that was
+ * executed, most executed first, with its disassembly and, for the
+ * branches, how often each went each way.
+ *
+ * 'WriteFoldedStacks' gives the same counts in the "folded stack" format
+ * that flame graph tools read, one line of frames separated by ';' and a
+ * count. A Pullet16 has no calls, so the frames are made from the shape
+ * of the code instead:
+ *   the root, usually the name of the program
+ *   one frame for each loop the code is in, outermost first, where a loop
+ *     is the code from the target of a branch that was taken backwards up
+ *     to the branch
+ *   the basic block, the run of code from one branch target or the
+ *     instruction after a branch up to the next
+ * and the count is the number of instructions executed in the block. A
+ * branch that goes different places, through an indirect address, is
+ * taken to go where it went last.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+/******************************************************************************
+ * Constructor
+**/
+Profiler::Profiler() {
+  this->Clear();
+}
+
+/******************************************************************************
+ * Destructor
+**/
+Profiler::~Profiler() {
+}
+
+/******************************************************************************
+ * Accessors and Mutators
+**/
+
+/******************************************************************************
+ * Accessor for the total number of instructions counted.
+**/
+LONG Profiler::GetTotal() const {
+  LONG total = 0;
+  for (auto iter = opcode_counts_.begin(); iter != opcode_counts_.end();
+       ++iter) {
+    total += *iter;
+  }
+  return total;
+}
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'Clear'.
+ * Set all the counts back to zero.
+**/
+void Profiler::Clear() {
+  pc_counts_.assign(Globals::kMaxMemory, 0);
+  words_.assign(Globals::kMaxMemory, 0);
+  taken_counts_.assign(Globals::kMaxMemory, 0);
+  not_taken_counts_.assign(Globals::kMaxMemory, 0);
+  branch_targets_.assign(Globals::kMaxMemory, 0);
+  opcode_counts_.assign(Globals::kHowManyMnemonics, 0);
+}
+
+/******************************************************************************
+ * Function 'FormatRange'.
+ * The name of a frame, the prefix and then the first and last PC as four
+ * digits each. Flame graph tools split the count off at the last blank,
+ * so the name has none after the prefix.
+**/
+string Profiler::FormatRange(string prefix, int first, int last) const {
+  ostringstream out;
+  out << prefix << setfill('0') << setw(4) << first << "-"
+      << setw(4) << last;
+  return out.str();
+}
+
+/******************************************************************************
+ * Function 'IsBranch'.
+ * Was the instruction last executed at 'pc' a BAN or a BR?
+**/
+bool Profiler::IsBranch(int pc) const {
+  int mnemonic = Globals::MnemonicIndex(words_[pc]);
+  return (pc_counts_[pc] > 0) &&
+         ((mnemonic == Globals::kBAN) || (mnemonic == Globals::kBR));
+}
+
+/******************************************************************************
+ * Function 'WriteFoldedStacks'.
+ * Write the counts as folded stacks, one line for each basic block.
+ *
+ * Parameters:
+ *   out_stream - where to write
+ *   root - the name of the bottom frame of every stack
+**/
+void Profiler::WriteFoldedStacks(ostream& out_stream, string root) const {
+  // A block starts at the first instruction, at every branch target,
+  // and after every branch.
+  vector<bool> is_leader(Globals::kMaxMemory, false);
+  is_leader[0] = true;
+  for (int pc = 0; pc < Globals::kMaxMemory; ++pc) {
+    if (this->IsBranch(pc)) {
+      if (pc + 1 < Globals::kMaxMemory) {
+        is_leader[pc + 1] = true;
+      }
+      if (taken_counts_[pc] > 0) {
+        is_leader[branch_targets_[pc]] = true;
+      }
+    }
+  }
+
+  // The loops, largest first so that the outer loops come first.
+  vector<pair<int, int> > loops;
+  for (int pc = 0; pc < Globals::kMaxMemory; ++pc) {
+    if (this->IsBranch(pc) && (taken_counts_[pc] > 0) &&
+        (branch_targets_[pc] <= pc)) {
+      loops.push_back(make_pair(branch_targets_[pc], pc));
+    }
+  }
+  sort(loops.begin(), loops.end(),
+       [](const pair<int, int>& a, const pair<int, int>& b) {
+         int a_size = a.second - a.first;
+         int b_size = b.second - b.first;
+         return (a_size != b_size) ? (a_size > b_size) : (a.first < b.first);
+       });
+
+  int pc = 0;
+  while (pc < Globals::kMaxMemory) {
+    if (pc_counts_[pc] == 0) {
+      ++pc;
+      continue;
+    }
+
+    int first = pc;
+    LONG how_many = 0;
+    do {
+      how_many += pc_counts_[pc];
+      ++pc;
+    } while ((pc < Globals::kMaxMemory) && !is_leader[pc] &&
+             (pc_counts_[pc] > 0));
+    int last = pc - 1;
+
+    out_stream << root;
+    for (auto iter = loops.begin(); iter != loops.end(); ++iter) {
+      if ((iter->first <= first) && (last <= iter->second)) {
+        out_stream << ";" << this->FormatRange("loop_", iter->first,
+                                               iter->second);
+      }
+    }
+    out_stream << ";" << this->FormatRange("", first, last) << " "
+               << how_many << endl;
+  }
+}
+
+/******************************************************************************
+ * Function 'WriteReport'.
+ * Write the counts by opcode and the hot spots, every PC that was
+ * executed with the most executed first.
+ *
+ * Parameter:
+ *   out_stream - where to write
+**/
+void Profiler::WriteReport(ostream& out_stream) const {
+  LONG total = this->GetTotal();
+  double scale = (total > 0) ? 100.0 / static_cast<double>(total) : 0.0;
+
+  out_stream << "PROFILE: " << total << " INSTRUCTIONS" << endl;
+  out_stream << endl;
+
+  out_stream << "OPCODE        COUNT  PERCENT" << endl;
+  for (int opcode = 0; opcode < Globals::kHowManyMnemonics; ++opcode) {
+    if (opcode_counts_[opcode] > 0) {
+      string name = Globals::kMnemonicNames[opcode];
+      name.resize(3, ' ');
+      out_stream << name << Utils::Format(opcode_counts_[opcode], 14)
+                 << Utils::Format(opcode_counts_[opcode] * scale, 9, 2)
+                 << endl;
+    }
+  }
+  out_stream << endl;
+
+  vector<int> pcs;
+  for (int pc = 0; pc < Globals::kMaxMemory; ++pc) {
+    if (pc_counts_[pc] > 0) {
+      pcs.push_back(pc);
+    }
+  }
+  stable_sort(pcs.begin(), pcs.end(), [this](int a, int b) {
+    return pc_counts_[a] > pc_counts_[b];
+  });
+
+  out_stream << "HOT SPOTS" << endl;
+  out_stream << "    PC         COUNT  PERCENT  CUMULATIVE  INSTRUCTION"
+             << "           TAKEN     NOT TAKEN" << endl;
+  LONG so_far = 0;
+  for (auto iter = pcs.begin(); iter != pcs.end(); ++iter) {
+    int pc = *iter;
+    so_far += pc_counts_[pc];
+    string instruction = Interpreter::Disassemble(words_[pc]);
+    out_stream << Utils::Format(pc, 6)
+               << Utils::Format(pc_counts_[pc], 14)
+               << Utils::Format(pc_counts_[pc] * scale, 9, 2)
+               << Utils::Format(so_far * scale, 12, 2) << "  "
+               << instruction;
+    if (this->IsBranch(pc)) {
+      out_stream << string(11 - instruction.length(), ' ')
+                 << Utils::Format(taken_counts_[pc], 16)
+                 << Utils::Format(not_taken_counts_[pc], 14);
+    }
+    out_stream << endl;
+  }
+}
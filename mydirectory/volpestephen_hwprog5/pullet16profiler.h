@@ -0,0 +1,71 @@
+/****************************************************************
+ * Header file for the Pullet16 execution profiler.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "../../Utilities/utils.h"
+
+#include "globals.h"
+
+class Profiler {
+  public:
+    Profiler();
+    virtual ~Profiler();
+
+    LONG GetTotal() const;
+
+    void Clear();
+    void WriteFoldedStacks(ostream& out_stream, string root) const;
+    void WriteReport(ostream& out_stream) const;
+
+    /**************************************************************************
+     * Function 'Count'.
+     * Count one execution of the instruction 'word' at 'pc'. This is on
+     * the path of every instruction, so it is inline and does no more than
+     * bump two counters and remember the word.
+    **/
+    void Count(int pc, int word) {
+      ++pc_counts_[pc];
+      words_[pc] = word;
+      ++opcode_counts_[Globals::MnemonicIndex(word)];
+    }
+
+    /**************************************************************************
+     * Function 'CountBranch'.
+     * Count the outcome of the branch at 'pc', which went to 'target', or
+     * was not taken if 'target' is negative.
+    **/
+    void CountBranch(int pc, int target) {
+      if (target >= 0) {
+        ++taken_counts_[pc];
+        branch_targets_[pc] = target;
+      } else {
+        ++not_taken_counts_[pc];
+      }
+    }
+
+  private:
+    vector<LONG> pc_counts_;
+    vector<int> words_;
+    vector<LONG> taken_counts_;
+    vector<LONG> not_taken_counts_;
+    vector<int> branch_targets_;
+    vector<LONG> opcode_counts_;
+
+    string FormatRange(string prefix, int first, int last) const;
+    bool IsBranch(int pc) const;
+};
+#endif
@@ -0,0 +1,616 @@
+#include "pullet16server.h"
+
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <streambuf>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/******************************************************************************
+ *3456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
+ * Class 'Server' for running Pullet16 jobs from a persistent process.
+ *
+ * Running 'Aprog' once per program pays for process startup and for the
+ * opening of the log file and the other files every time. The server
+ * instead listens on a Unix domain socket and hands each connection to one
+ * of a pool of pre-forked worker processes that are already warm.
+ *
+ * A job is a set of text lines sent by the client, one request per line:
+ *
+ *   EXEC name      the executable 'name.txt' (no extension, as for 'Aprog')
+ *   IMAGE          the executable follows inline, one word per line,
+ *                  terminated by a line 'END'
+ *   DATA name      the data file 'name.txt' for the RD instruction
+ *   INPUT          the data follows inline, terminated by a line 'END'
+ *   TRACE level    the interpreter trace level (0, 1, or 2; default 0)
+ *   LOG name       the log file 'name.txt' for the trace
+ *   MAX n          the instruction count at which the job times out
+ *                  (default as for 'Aprog')
+ *   RUN            run the job
+ *
+ * A line may be at most 1024 characters, and IMAGE and INPUT at most
+ * 65536 lines, so that a client can't run a worker out of memory.
+ *
+ * The WRT output is streamed back over the connection as it is written,
+ * and the job ends with a single line that is one of
+ *
+ *   STATUS OK count        the program stopped normally
+ *   STATUS TIMEOUT count   the program was stopped at the MAX count
+ *   STATUS ERROR message   the request could not be run
+ *   STATUS FAULT count     the program crashed the machine
+ *
+ * The interpreter is told not to exit on a fault, so a fault ends only the
+ * job and the worker stays warm for the next one. The parent process
+ * still forks a fresh worker if one dies for any other reason.
+ *
+ * 'Load' writes and rereads the binary 'test.bin' in the working
+ * directory, so each worker runs in a directory of its own that it makes
+ * when it is forked. File names in a job are of files in the directory
+ * the server was started in, and a name with a '/' or a '..' is refused,
+ * so that a client can't read or overwrite files anywhere else. The
+ * socket is made readable and writable by its owner only.
+ *
+ * 'RunClient' is a client for scripts: it sends a job from its standard
+ * input and copies what comes back to its standard output.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+**/
+
+static const string kTag = "Server: ";
+static const UINT kMaxInlineLines = 65536;
+
+volatile int Server::shutting_down_ = 0;
+
+/******************************************************************************
+ * A 'streambuf' that writes to a socket, so that the interpreter's WRT
+ * output can be streamed back to the client through an 'ostream'.
+**/
+class SocketStreamBuf : public std::streambuf {
+  public:
+    explicit SocketStreamBuf(int fd) : fd_(fd) {
+      this->setp(buffer_, buffer_ + sizeof(buffer_));
+    }
+
+    virtual ~SocketStreamBuf() {
+      this->sync();
+    }
+
+  protected:
+    virtual int overflow(int c) {
+      if (this->sync() != 0) return traits_type::eof();
+      if (c != traits_type::eof()) {
+        *this->pptr() = static_cast<char>(c);
+        this->pbump(1);
+      }
+      return traits_type::not_eof(c);
+    }
+
+    virtual int sync() {
+      const char* next = this->pbase();
+      while (next < this->pptr()) {
+        ssize_t how_many = write(fd_, next, this->pptr() - next);
+        if (how_many < 0) {
+          if (errno == EINTR) continue;
+          this->setp(buffer_, buffer_ + sizeof(buffer_));
+          return -1;
+        }
+        next += how_many;
+      }
+      this->setp(buffer_, buffer_ + sizeof(buffer_));
+      return 0;
+    }
+
+  private:
+    int fd_;
+    char buffer_[4096];
+};
+
+/******************************************************************************
+ * Whether a file name from a job is of a file in the server's directory.
+ * A name with a '/' or a '..' could be of a file somewhere else.
+**/
+static bool IsSafeName(const string& name) {
+  return (name.find('/') == string::npos) &&
+         (name.find("..") == string::npos);
+}
+
+/******************************************************************************
+ * Reads the lines of a job from a socket, a buffer at a time rather than a
+ * byte at a time. A line longer than 'kMaxLineLength' ends the reading,
+ * and 'IsTooLong' says so, so that a client can't make a worker hold an
+ * endless line.
+**/
+class SocketLineReader {
+  public:
+    explicit SocketLineReader(int fd) : fd_(fd), next_(0), end_(0),
+                                        is_too_long_(false) {
+    }
+
+    bool IsTooLong() const {
+      return is_too_long_;
+    }
+
+    /**************************************************************************
+     * Read one line, without the newline.
+     *
+     * Returns:
+     *   false if the connection was closed before a complete line was
+     *   read, or the line is too long
+    **/
+    bool ReadLine(string& line) {
+      line = "";
+      while (!is_too_long_) {
+        if (next_ == end_) {
+          ssize_t how_many = read(fd_, buffer_, sizeof(buffer_));
+          if (how_many < 0 && errno == EINTR) continue;
+          if (how_many <= 0) return false;
+          next_ = 0;
+          end_ = how_many;
+        }
+        char c = buffer_[next_++];
+        if (c == '\n') return true;
+        if (c != '\r') line += c;
+        if (line.length() > kMaxLineLength) {
+          is_too_long_ = true;
+        }
+      }
+      return false;
+    }
+
+  private:
+    static const UINT kMaxLineLength = 1024;
+
+    int fd_;
+    char buffer_[4096];
+    ssize_t next_;
+    ssize_t end_;
+    bool is_too_long_;
+};
+
+/******************************************************************************
+ * Constructor
+**/
+Server::Server() {
+  listen_fd_ = -1;
+}
+
+/******************************************************************************
+ * Destructor
+**/
+Server::~Server() {
+}
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'HandleJob'.
+ * Read one job from the connection, run it, and report the status.
+ *
+ * A fresh 'Interpreter' is used for every job because 'Load' appends to
+ * the memory of the machine.
+ *
+ * Parameter:
+ *   connection_fd - the accepted socket for this job
+**/
+void Server::HandleJob(int connection_fd) {
+#ifdef EBUG
+  Utils::log_stream << "enter HandleJob\n";
+#endif
+
+  string exec_filename = "";
+  string data_filename = "";
+  string log_filename = "";
+  vector<string> image_lines;
+  vector<string> input_lines;
+  bool have_image = false;
+  bool have_input = false;
+  int trace_level = Interpreter::kTraceNone;
+  int max_instructions = 0;
+  string error_message = "";
+
+  SocketLineReader reader(connection_fd);
+  string line;
+  bool got_run = false;
+  while (!got_run && reader.ReadLine(line)) {
+    string keyword = line.substr(0, line.find(' '));
+    string argument = "";
+    if (line.find(' ') != string::npos) {
+      argument = Utils::Trim(line.substr(line.find(' ') + 1));
+    }
+
+    if (keyword == "EXEC") {
+      exec_filename = argument;
+    } else if (keyword == "DATA") {
+      data_filename = argument;
+    } else if (keyword == "LOG") {
+      log_filename = argument;
+    } else if (keyword == "TRACE") {
+      trace_level = atoi(argument.c_str());
+    } else if (keyword == "MAX") {
+      max_instructions = atoi(argument.c_str());
+      if (max_instructions < 1) {
+        error_message = "BAD MAX '" + argument + "'";
+      }
+    } else if ((keyword == "IMAGE") || (keyword == "INPUT")) {
+      vector<string>& lines = (keyword == "IMAGE") ? image_lines : input_lines;
+      while (reader.ReadLine(line) && (line != "END")) {
+        if (lines.size() >= kMaxInlineLines) {
+          error_message = "TOO MANY LINES";
+        } else {
+          lines.push_back(line);
+        }
+      }
+      if (keyword == "IMAGE") have_image = true;
+      else have_input = true;
+    } else if (keyword == "RUN") {
+      got_run = true;
+    } else if (keyword != "") {
+      error_message = "UNKNOWN REQUEST '" + keyword + "'";
+    }
+  }
+
+  if (reader.IsTooLong()) {
+    error_message = "LINE TOO LONG";
+  } else if (!got_run) {
+    return; // the client went away
+  }
+
+  if ((error_message == "") &&
+      (!IsSafeName(exec_filename) || !IsSafeName(data_filename) ||
+       !IsSafeName(log_filename))) {
+    error_message = "BAD FILE NAME";
+  }
+  if (error_message == "" && exec_filename == "" && !have_image) {
+    error_message = "NO EXECUTABLE";
+  }
+  if (error_message == "" && data_filename == "" && !have_input) {
+    error_message = "NO DATA";
+  }
+
+  // The scanners can only open a named file, so inline text is put into a
+  // temporary file that is removed as soon as it has been opened.
+  Scanner exec_scanner;
+  Scanner data_scanner;
+  string binary_filename = "dummybinaryname";
+  if (error_message == "") {
+    string name = have_image ? this->WriteTempFile(image_lines)
+                             : this->ResolveName(exec_filename) + ".txt";
+    if (Utils::FileDoesNotExist(name)) {
+      error_message = "CANNOT OPEN EXECUTABLE";
+    } else {
+      exec_scanner.OpenFile(name);
+      if (have_image) unlink(name.c_str());
+      else binary_filename = this->ResolveName(exec_filename) + ".bin";
+    }
+  }
+  if (error_message == "") {
+    string name = have_input ? this->WriteTempFile(input_lines)
+                             : this->ResolveName(data_filename) + ".txt";
+    if (Utils::FileDoesNotExist(name)) {
+      error_message = "CANNOT OPEN DATA";
+    } else {
+      data_scanner.OpenFile(name);
+      if (have_input) unlink(name.c_str());
+    }
+  }
+
+  SocketStreamBuf out_buf(connection_fd);
+  ostream out_stream(&out_buf);
+
+  if (error_message != "") {
+    out_stream << "STATUS ERROR " << error_message << endl;
+    return;
+  }
+
+  // Each job has a log of its own. If it is not opened, what the
+  // interpreter writes to it is simply dropped.
+  LogSink log_stream;
+  if ((trace_level > Interpreter::kTraceNone) && (log_filename != "")) {
+    log_stream.open((this->ResolveName(log_filename) + ".txt").c_str());
+  }
+
+  Interpreter interpreter;
+  interpreter.SetLogStream(log_stream);
+  interpreter.SetExitOnFault(false);
+  interpreter.SetTraceLevel(trace_level);
+  if (max_instructions > 0) {
+    interpreter.SetMaxInstructions(max_instructions);
+  }
+  interpreter.Load(exec_scanner, binary_filename);
+  exec_scanner.Close();
+  interpreter.Interpret(data_scanner, out_stream);
+
+  // An STP is not counted, so only a timeout reaches the maximum.
+  if (interpreter.IsFaulted()) {
+    out_stream << "STATUS FAULT " << interpreter.GetInstructionCount()
+               << endl;
+  } else if (interpreter.GetInstructionCount() >=
+             interpreter.GetMaxInstructions()) {
+    out_stream << "STATUS TIMEOUT " << interpreter.GetInstructionCount()
+               << endl;
+  } else {
+    out_stream << "STATUS OK " << interpreter.GetInstructionCount() << endl;
+  }
+
+  if (log_stream.is_open()) {
+    log_stream.close();
+  }
+
+#ifdef EBUG
+  Utils::log_stream << "leave HandleJob\n";
+#endif
+}
+
+/******************************************************************************
+ * Function 'HandleSignal'.
+ * Note that we have been asked to stop. The blocking calls are interrupted
+ * and the loops check the flag.
+**/
+void Server::HandleSignal(int signal_number) {
+  shutting_down_ = 1;
+}
+
+/******************************************************************************
+ * Function 'ResolveName'.
+ * Make a file name from a job into the name of the file in the directory
+ * the server was started in, since the worker runs in a directory of its
+ * own. The name must already have passed 'IsSafeName'.
+ *
+ * Parameter:
+ *   name - the file name as the client sent it
+ *
+ * Returns:
+ *   the name to open
+**/
+string Server::ResolveName(string name) const {
+  return server_directory_ + "/" + name;
+}
+
+/******************************************************************************
+ * Function 'Run'.
+ * This top level function runs the server until it is sent SIGINT or
+ * SIGTERM.
+ *
+ * We bind the socket, fork the workers, and then just wait, forking a new
+ * worker whenever one of them dies.
+ *
+ * Parameters:
+ *   socket_path - the file system name of the Unix domain socket
+ *   how_many_workers - the size of the worker pool
+ *
+ * Returns:
+ *   the exit status for the program
+**/
+int Server::Run(string socket_path, int how_many_workers) {
+#ifdef EBUG
+  Utils::log_stream << "enter Run\n";
+#endif
+
+  socket_path_ = socket_path;
+
+  char directory[PATH_MAX];
+  if (getcwd(directory, sizeof(directory)) == NULL) {
+    cout << kTag << "getcwd failed: " << strerror(errno) << endl;
+    return 1;
+  }
+  server_directory_ = directory;
+
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path_.length() >= sizeof(address.sun_path)) {
+    cout << kTag << "socket path '" << socket_path_ << "' is too long" << endl;
+    return 1;
+  }
+  strncpy(address.sun_path, socket_path_.c_str(), sizeof(address.sun_path) - 1);
+
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    cout << kTag << "socket failed: " << strerror(errno) << endl;
+    return 1;
+  }
+  unlink(socket_path_.c_str());
+  mode_t old_mask = umask(0077);
+  int bound = bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&address),
+                   sizeof(address));
+  umask(old_mask);
+  if (bound < 0) {
+    cout << kTag << "bind to '" << socket_path_ << "' failed: "
+         << strerror(errno) << endl;
+    return 1;
+  }
+  if (listen(listen_fd_, 64) < 0) {
+    cout << kTag << "listen failed: " << strerror(errno) << endl;
+    return 1;
+  }
+
+  // No SA_RESTART, so that 'waitpid' and 'accept' return on a signal.
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = Server::HandleSignal;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  cout << kTag << "listening on '" << socket_path_ << "' with "
+       << how_many_workers << " workers" << endl;
+
+  for (int i = 0; i < how_many_workers; ++i) {
+    workers_.push_back(this->SpawnWorker());
+  }
+
+  while (!shutting_down_) {
+    int status = 0;
+    pid_t dead = waitpid(-1, &status, 0);
+    if (dead < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    for (auto iter = workers_.begin(); iter != workers_.end(); ++iter) {
+      if (*iter == dead) {
+        *iter = this->SpawnWorker();
+        break;
+      }
+    }
+  }
+
+  for (auto iter = workers_.begin(); iter != workers_.end(); ++iter) {
+    kill(*iter, SIGTERM);
+  }
+  for (auto iter = workers_.begin(); iter != workers_.end(); ++iter) {
+    waitpid(*iter, NULL, 0);
+  }
+  close(listen_fd_);
+  unlink(socket_path_.c_str());
+
+  cout << kTag << "shut down" << endl;
+
+#ifdef EBUG
+  Utils::log_stream << "leave Run\n";
+#endif
+
+  return 0;
+}
+
+/******************************************************************************
+ * Function 'RunClient'.
+ * Send a job to a server and copy the answer back, until the server
+ * closes the connection after the STATUS line.
+ *
+ * Parameters:
+ *   socket_path - the file system name of the server's socket
+ *   in_stream - the lines of the job
+ *   out_stream - where the answer goes
+ *
+ * Returns:
+ *   the exit status for the program
+**/
+int Server::RunClient(string socket_path, istream& in_stream,
+                      ostream& out_stream) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.length() >= sizeof(address.sun_path)) {
+    out_stream << kTag << "socket path '" << socket_path << "' is too long"
+               << endl;
+    return 1;
+  }
+  strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if ((fd < 0) ||
+      (connect(fd, reinterpret_cast<struct sockaddr*>(&address),
+               sizeof(address)) < 0)) {
+    out_stream << kTag << "connect to '" << socket_path << "' failed: "
+               << strerror(errno) << endl;
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  {
+    SocketStreamBuf job_buf(fd);
+    ostream job_stream(&job_buf);
+    string line;
+    while (getline(in_stream, line)) {
+      job_stream << line << "\n";
+    }
+  }
+  shutdown(fd, SHUT_WR);
+
+  char buffer[4096];
+  while (true) {
+    ssize_t how_many = read(fd, buffer, sizeof(buffer));
+    if (how_many < 0 && errno == EINTR) continue;
+    if (how_many <= 0) break;
+    out_stream.write(buffer, how_many);
+  }
+  out_stream.flush();
+  close(fd);
+  return 0;
+}
+
+/******************************************************************************
+ * Function 'ServeForever'.
+ * The loop run by a worker: accept a connection, run its job, repeat.
+ * All the workers accept on the same listening socket.
+ *
+ * The worker works in a fresh directory under '/tmp', which it removes
+ * when it is told to stop.
+**/
+void Server::ServeForever() {
+  char directory[] = "/tmp/aprogworkerXXXXXX";
+  if ((mkdtemp(directory) == NULL) || (chdir(directory) < 0)) {
+    cout << kTag << "no working directory: " << strerror(errno) << endl;
+    _exit(1);
+  }
+
+  while (!shutting_down_) {
+    int connection_fd = accept(listen_fd_, NULL, NULL);
+    if (connection_fd < 0) {
+      continue;
+    }
+    this->HandleJob(connection_fd);
+    close(connection_fd);
+  }
+
+  unlink("test.bin");
+  if (chdir(server_directory_.c_str()) == 0) {
+    rmdir(directory);
+  }
+  _exit(0);
+}
+
+/******************************************************************************
+ * Function 'SpawnWorker'.
+ * Fork one worker process.
+ *
+ * Returns:
+ *   the process id of the worker, in the parent
+**/
+pid_t Server::SpawnWorker() {
+  cout.flush();
+  pid_t pid = fork();
+  if (pid < 0) {
+    cout << kTag << "fork failed: " << strerror(errno) << endl;
+    exit(1);
+  }
+  if (pid == 0) {
+    this->ServeForever();
+  }
+  return pid;
+}
+
+/******************************************************************************
+ * Function 'WriteTempFile'.
+ * Write lines of text received inline to a temporary file.
+ *
+ * Parameter:
+ *   lines - the lines to write
+ *
+ * Returns:
+ *   the name of the temporary file
+**/
+string Server::WriteTempFile(const vector<string>& lines) {
+  char name[] = "/tmp/aprogXXXXXX";
+  int fd = mkstemp(name);
+  if (fd < 0) {
+    return "";
+  }
+  FILE* fp = fdopen(fd, "w");
+  for (auto iter = lines.begin(); iter != lines.end(); ++iter) {
+    fprintf(fp, "%s\n", iter->c_str());
+  }
+  fclose(fp);
+  return string(name);
+}
@@ -0,0 +1,52 @@
+/****************************************************************
+ * Header file for the Pullet16 job server.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+#ifndef SERVER_H
+#define SERVER_H
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+using namespace std;
+
+#include "../../Utilities/scanner.h"
+#include "../../Utilities/scanline.h"
+#include "../../Utilities/utils.h"
+
+#include "pullet16interpreter.h"
+
+class Server {
+  public:
+    static const int kDefaultWorkers = 4;
+
+    Server();
+    virtual ~Server();
+
+    int Run(string socket_path, int how_many_workers);
+
+    static int RunClient(string socket_path, istream& in_stream,
+                         ostream& out_stream);
+
+  private:
+    static volatile int shutting_down_;
+
+    int listen_fd_;
+    string server_directory_;
+    string socket_path_;
+    vector<pid_t> workers_;
+
+    void HandleJob(int connection_fd);
+    static void HandleSignal(int signal_number);
+    string ResolveName(string name) const;
+    void ServeForever();
+    pid_t SpawnWorker();
+    string WriteTempFile(const vector<string>& lines);
+};
+#endif
@@ -0,0 +1,920 @@
+#include "pullet16trace.h"
+
+/******************************************************************************
+ *3456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
+ * Classes 'TraceWriter', 'TraceReader', and 'FlightRecorder' for the
+ * binary execution trace.
+ *
+ * The text trace formats dozens of lines for every instruction. The binary
+ * trace instead copies one fixed-width 'TraceRecord' per instruction into
+ * a large buffer, and 'TraceDecoder' turns the records back into the text
+ * afterwards, only if someone wants to read it.
+ *
+ * A trace file is
+ *   the four bytes "P16T", or "P16C" if the records are compressed
+ *   the trace level the text is to be regenerated at, as 4 bytes
+ *   the length of the text log when the trace started, as 8 bytes, since
+ *     the text of the instructions goes at that point in the log
+ *   the size of the executable and the words of memory after loading,
+ *     as 4 bytes and then 2 bytes for each word
+ *   the records
+ * all in the byte order of the host.
+ *
+ * Uncompressed, the records are simply one after another to the end of
+ * the file.
+ *
+ * Compressed, the records are in blocks of up to 'kBlockRecords'. Within
+ * a block each record is stored as its difference from the one before,
+ * which for a Pullet16 is nearly always small: the index goes up by one,
+ * the PC goes up by one, and the accumulator changes a little. A record
+ * is a byte of flags and then varints of
+ *   the index, less one more than the index before
+ *   the PC, less one more than the PC before
+ *   the instruction word, unless it is the same as the last time this PC
+ *     was executed in the block, which a flag says
+ *   the effective address less the one before, if there is one
+ *   the accumulator before less the accumulator after the record before
+ *   the accumulator after less the accumulator before
+ *   the operand less what the opcode says it should be, which is the
+ *     accumulator for a load or a store, the change in the accumulator for
+ *     an add, subtract, or AND, and otherwise the operand before
+ * with signed differences zigzag encoded. A block is
+ *   'B', the index of its first record, and the number of records
+ *   0 if the bytes of the records follow as they are, or 1 if they have
+ *     been packed with the LZ compressor below
+ *   the length of the bytes of the records, and the length stored
+ *   the stored bytes
+ * with the numbers as varints. Every block starts from a zero record, so
+ * any block can be decoded by itself. After the last block come an index
+ * of the first record and file offset of every block, as 'I', a count,
+ * and pairs of varints, and then the offset of the index as 8 bytes and
+ * the four bytes "P16X", which 'TraceReader' uses to seek to any record.
+ *
+ * The 'FlightRecorder' keeps the same records in memory instead, in a ring
+ * of the last few instructions, so that they can be shown if the run ends
+ * in a crash or a timeout and cost nothing but a copy if it does not.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+**/
+
+const char TraceWriter::kMagic[] = "P16T";
+const char TraceWriter::kCompressedMagic[] = "P16C";
+
+static const char kIndexMagic[] = "P16X";
+static const int kHashBits = 12;
+static const int kMinMatch = 4;
+static const int kMaxOffset = 65535;
+
+// A record is a flag byte and at most seven varints of at most ten bytes,
+// so no block of a trace we wrote is longer than this. Lengths read from a
+// file are checked against it before anything is allocated.
+static const LONG kMaxRecordBytes = 1 + 7 * 10;
+static const LONG kMaxBlockBytes = TraceWriter::kBlockRecords *
+                                   kMaxRecordBytes;
+
+/******************************************************************************
+ * Zigzag encoding of signed numbers, so that small negative numbers make
+ * small varints too.
+**/
+static LONG ZigZag(LONG value) {
+  return static_cast<LONG>((static_cast<uint64_t>(value) << 1) ^
+                           static_cast<uint64_t>(value >> 63));
+}
+
+static LONG UnZigZag(LONG value) {
+  return static_cast<LONG>(static_cast<uint64_t>(value) >> 1) ^ -(value & 1);
+}
+
+/******************************************************************************
+ * The flag bits of a compressed record beyond those of 'TraceRecord'.
+**/
+static const int kHasAddress = 8;
+static const int kSameWord = 16;
+
+/******************************************************************************
+ * What the operand of a record is expected to be, given the rest of it.
+**/
+static LONG PredictOperand(const TraceRecord& record,
+                           const TraceRecord& previous) {
+  switch (record.opcode) {
+    case 1:
+      return static_cast<LONG>(record.accum_before) - record.accum_after;
+    case 2:
+      return record.accum_before;
+    case 3:
+    case 5:
+      return record.accum_after;
+    case 4:
+      return static_cast<LONG>(record.accum_after) - record.accum_before;
+    default:
+      return previous.operand;
+  }
+}
+
+/******************************************************************************
+ * A small LZ77 compressor for blocks of records. The output is a series of
+ * a varint count of literal bytes, the literals, and then, unless the end
+ * has been reached, a varint match length less 'kMinMatch' and a varint
+ * offset back into what has already been produced. The loops of a program
+ * give long runs of identical record bytes, which this packs well.
+**/
+static void Compress(const char* in, UINT length, vector<char>& out) {
+  vector<int> table(1 << kHashBits, -1);
+  UINT anchor = 0;
+  UINT position = 0;
+  while (position + kMinMatch <= length) {
+    UINT quad = 0;
+    memcpy(&quad, in + position, sizeof(quad));
+    UINT hash = (quad * 2654435761u) >> (32 - kHashBits);
+    int candidate = table[hash];
+    table[hash] = position;
+
+    if ((candidate < 0) || (position - candidate > kMaxOffset) ||
+        (memcmp(in + candidate, in + position, kMinMatch) != 0)) {
+      ++position;
+      continue;
+    }
+
+    UINT match = kMinMatch;
+    while ((position + match < length) &&
+           (in[candidate + match] == in[position + match])) {
+      ++match;
+    }
+
+    Varint::Put(out, position - anchor);
+    out.insert(out.end(), in + anchor, in + position);
+    Varint::Put(out, match - kMinMatch);
+    Varint::Put(out, position - candidate);
+    position += match;
+    anchor = position;
+  }
+
+  Varint::Put(out, length - anchor);
+  out.insert(out.end(), in + anchor, in + length);
+}
+
+static bool Decompress(const vector<char>& in, UINT length,
+                       vector<char>& out) {
+  out.clear();
+  if (length > kMaxBlockBytes) {
+    return false;
+  }
+  out.reserve(length);
+  UINT position = 0;
+  while (true) {
+    LONG literals = 0;
+    if (!Varint::Get(in, position, literals) || (literals < 0) ||
+        (position + literals > static_cast<LONG>(in.size()))) {
+      return false;
+    }
+    out.insert(out.end(), in.begin() + position,
+               in.begin() + position + literals);
+    position += literals;
+    if (out.size() >= length) break;
+
+    LONG match = 0;
+    LONG offset = 0;
+    if (!Varint::Get(in, position, match) ||
+        !Varint::Get(in, position, offset) || (offset <= 0) ||
+        (offset > static_cast<LONG>(out.size())) ||
+        (match < 0) || (match + kMinMatch >
+                        static_cast<LONG>(length - out.size()))) {
+      return false;
+    }
+    match += kMinMatch;
+    UINT from = out.size() - offset;
+    for (LONG i = 0; i < match; ++i) {
+      out.push_back(out[from + i]);
+    }
+  }
+  return out.size() == length;
+}
+
+/******************************************************************************
+ * Constructor
+**/
+TraceWriter::TraceWriter() {
+  fp_ = NULL;
+  buffer_used_ = 0;
+  compression_ = kCompressNone;
+  block_count_ = 0;
+  block_first_index_ = 0;
+}
+
+/******************************************************************************
+ * Destructor
+**/
+TraceWriter::~TraceWriter() {
+  this->Close();
+}
+
+/******************************************************************************
+ * Accessors and Mutators
+**/
+
+/******************************************************************************
+ * Mutator for 'compression_', which must be set before 'Open'.
+ *
+ * The choices are
+ *   kCompressNone  - fixed-width records, the cheapest to write
+ *   kCompressDelta - records as varint differences
+ *   kCompressBlock - the differences further packed block by block
+**/
+void TraceWriter::SetCompression(int compression) {
+  compression_ = compression;
+}
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'Close'.
+ * Write out what is left in the buffer, and for a compressed trace the
+ * index, and close the file.
+**/
+void TraceWriter::Close() {
+  if (fp_ == NULL) {
+    return;
+  }
+  this->Flush();
+
+  if (compression_ != kCompressNone) {
+    int64_t index_offset = ftello(fp_);
+    vector<char> bytes;
+    bytes.push_back('I');
+    Varint::Put(bytes, index_.size());
+    for (auto iter = index_.begin(); iter != index_.end(); ++iter) {
+      Varint::Put(bytes, iter->first_index);
+      Varint::Put(bytes, iter->file_offset);
+    }
+    fwrite(&bytes[0], 1, bytes.size(), fp_);
+    fwrite(&index_offset, sizeof(index_offset), 1, fp_);
+    fwrite(kIndexMagic, 1, 4, fp_);
+  }
+
+  fclose(fp_);
+  fp_ = NULL;
+}
+
+/******************************************************************************
+ * Function 'EncodeRecord'.
+ * Add one record to the current block as differences from the record
+ * before, writing the block out when it is full.
+**/
+void TraceWriter::EncodeRecord(const TraceRecord& record) {
+  if (block_count_ == 0) {
+    memset(&previous_, 0, sizeof(previous_));
+    previous_.instruction_index = record.instruction_index - 1;
+    block_first_index_ = record.instruction_index;
+    block_words_.assign(Globals::kMaxMemory, -1);
+    buffer_.clear();
+  }
+
+  bool has_address = (record.address != TraceRecord::kNoAddress);
+  bool is_same_word = (block_words_[record.pc] == record.word);
+  block_words_[record.pc] = record.word;
+  buffer_.push_back(static_cast<char>(record.flags |
+                                      (has_address ? kHasAddress : 0) |
+                                      (is_same_word ? kSameWord : 0)));
+  Varint::Put(buffer_, ZigZag(static_cast<LONG>(record.instruction_index) -
+                            previous_.instruction_index - 1));
+  Varint::Put(buffer_, ZigZag(static_cast<LONG>(record.pc) - previous_.pc - 1));
+  if (!is_same_word) {
+    Varint::Put(buffer_, record.word);
+  }
+  if (has_address) {
+    Varint::Put(buffer_, ZigZag(static_cast<LONG>(record.address) -
+                              previous_.address));
+  }
+  Varint::Put(buffer_, ZigZag(static_cast<LONG>(record.accum_before) -
+                            previous_.accum_after));
+  Varint::Put(buffer_, ZigZag(static_cast<LONG>(record.accum_after) -
+                            record.accum_before));
+  Varint::Put(buffer_, ZigZag(record.operand -
+                            PredictOperand(record, previous_)));
+
+  int address = previous_.address;
+  previous_ = record;
+  if (!has_address) {
+    previous_.address = address;
+  }
+
+  ++block_count_;
+  if (block_count_ >= kBlockRecords) {
+    this->WriteBlock();
+  }
+}
+
+/******************************************************************************
+ * Function 'Flush'.
+ * Write out the buffer, or for a compressed trace the block so far.
+**/
+void TraceWriter::Flush() {
+  if (fp_ == NULL) {
+    return;
+  }
+  if (compression_ != kCompressNone) {
+    this->WriteBlock();
+  } else if (buffer_used_ > 0) {
+    fwrite(&buffer_[0], 1, buffer_used_, fp_);
+  }
+  fflush(fp_);
+  buffer_used_ = 0;
+}
+
+/******************************************************************************
+ * Function 'Open'.
+ * Create the trace file and write its header.
+ *
+ * Parameters:
+ *   filename - the name of the trace file
+ *   trace_level - the level to regenerate the text at
+ *   log_offset - the length of the text log at this point
+ *   image - the words of memory after loading
+ *
+ * Returns:
+ *   false if the file can't be created
+**/
+bool TraceWriter::Open(string filename, int trace_level, LONG log_offset,
+                       const vector<int>& image) {
+  this->Close();
+  fp_ = fopen(filename.c_str(), "wb");
+  if (fp_ == NULL) {
+    return false;
+  }
+
+  if (compression_ == kCompressNone) {
+    buffer_.resize(kBufferSize);
+  } else {
+    buffer_.clear();
+    buffer_.reserve(kBufferSize);
+  }
+  buffer_used_ = 0;
+  block_count_ = 0;
+  index_.clear();
+
+  int32_t level = trace_level;
+  int64_t offset = log_offset;
+  int32_t memory_size = image.size();
+  fwrite((compression_ == kCompressNone) ? kMagic : kCompressedMagic,
+         1, 4, fp_);
+  fwrite(&level, sizeof(level), 1, fp_);
+  fwrite(&offset, sizeof(offset), 1, fp_);
+  fwrite(&memory_size, sizeof(memory_size), 1, fp_);
+  for (auto iter = image.begin(); iter != image.end(); ++iter) {
+    uint16_t word = *iter;
+    fwrite(&word, sizeof(word), 1, fp_);
+  }
+
+  return ferror(fp_) == 0;
+}
+
+/******************************************************************************
+ * Function 'WriteBlock'.
+ * Write out the current block of a compressed trace and note where it is
+ * in the index.
+**/
+void TraceWriter::WriteBlock() {
+  if (block_count_ == 0) {
+    return;
+  }
+
+  TraceIndexEntry entry;
+  entry.first_index = block_first_index_;
+  entry.file_offset = ftello(fp_);
+  index_.push_back(entry);
+
+  int method = 0;
+  vector<char> packed;
+  if (compression_ == kCompressBlock) {
+    Compress(&buffer_[0], buffer_.size(), packed);
+    if (packed.size() < buffer_.size()) {
+      method = 1;
+    }
+  }
+  const vector<char>& stored = (method == 1) ? packed : buffer_;
+
+  vector<char> header;
+  header.push_back('B');
+  Varint::Put(header, block_first_index_);
+  Varint::Put(header, block_count_);
+  header.push_back(static_cast<char>(method));
+  Varint::Put(header, buffer_.size());
+  Varint::Put(header, stored.size());
+  fwrite(&header[0], 1, header.size(), fp_);
+  fwrite(&stored[0], 1, stored.size(), fp_);
+
+  block_count_ = 0;
+  buffer_.clear();
+}
+
+/******************************************************************************
+ * Constructor
+**/
+FlightRecorder::FlightRecorder() {
+  next_ = 0;
+  how_many_ = 0;
+}
+
+/******************************************************************************
+ * Destructor
+**/
+FlightRecorder::~FlightRecorder() {
+}
+
+/******************************************************************************
+ * Accessors and Mutators
+**/
+
+/******************************************************************************
+ * Accessor for the number of instructions the ring holds.
+**/
+int FlightRecorder::GetSize() const {
+  return ring_.size();
+}
+
+/******************************************************************************
+ * Mutator for the number of instructions the ring holds. This empties the
+ * ring, and 0 turns the recorder off.
+**/
+void FlightRecorder::SetSize(int size) {
+  ring_.assign((size > 0) ? size : 0, TraceRecord());
+  next_ = 0;
+  how_many_ = 0;
+}
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'GetRecords'.
+ * The instructions in the ring, oldest first.
+**/
+vector<TraceRecord> FlightRecorder::GetRecords() const {
+  vector<TraceRecord> records;
+  LONG size = ring_.size();
+  if (how_many_ < size) {
+    records.assign(ring_.begin(), ring_.begin() + how_many_);
+  } else {
+    records.assign(ring_.begin() + next_, ring_.end());
+    records.insert(records.end(), ring_.begin(), ring_.begin() + next_);
+  }
+  return records;
+}
+
+/******************************************************************************
+ * Constructor
+**/
+TraceReader::TraceReader() {
+  fp_ = NULL;
+  is_compressed_ = false;
+  trace_level_ = 0;
+  log_offset_ = 0;
+  records_offset_ = 0;
+  block_used_ = 0;
+  block_records_left_ = 0;
+  has_lookahead_ = false;
+}
+
+/******************************************************************************
+ * Destructor
+**/
+TraceReader::~TraceReader() {
+  this->Close();
+}
+
+/******************************************************************************
+ * Accessors and Mutators
+**/
+
+/******************************************************************************
+ * Accessor for 'image_', memory as it was when the trace started.
+**/
+const vector<int>& TraceReader::GetImage() const {
+  return image_;
+}
+
+/******************************************************************************
+ * Accessor for 'log_offset_', where the text goes in the text log.
+**/
+LONG TraceReader::GetLogOffset() const {
+  return log_offset_;
+}
+
+/******************************************************************************
+ * Accessor for 'trace_level_', the level to regenerate the text at.
+**/
+int TraceReader::GetTraceLevel() const {
+  return trace_level_;
+}
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'Close'.
+**/
+void TraceReader::Close() {
+  if (fp_ != NULL) {
+    fclose(fp_);
+    fp_ = NULL;
+  }
+}
+
+/******************************************************************************
+ * Function 'DecodeRecord'.
+ * Decode the next record of the current block.
+**/
+bool TraceReader::DecodeRecord(TraceRecord& record) {
+  if (block_used_ >= block_.size()) {
+    return false;
+  }
+  int flags = static_cast<unsigned char>(block_[block_used_++]);
+
+  LONG index = 0;
+  LONG pc = 0;
+  LONG word = 0;
+  LONG address = 0;
+  LONG accum_before = 0;
+  LONG accum_change = 0;
+  LONG operand = 0;
+  if (!Varint::Get(block_, block_used_, index) ||
+      !Varint::Get(block_, block_used_, pc) ||
+      (!(flags & kSameWord) && !Varint::Get(block_, block_used_, word)) ||
+      ((flags & kHasAddress) && !Varint::Get(block_, block_used_, address)) ||
+      !Varint::Get(block_, block_used_, accum_before) ||
+      !Varint::Get(block_, block_used_, accum_change) ||
+      !Varint::Get(block_, block_used_, operand)) {
+    return false;
+  }
+
+  record.instruction_index = previous_.instruction_index + 1 +
+                             UnZigZag(index);
+  record.pc = previous_.pc + 1 + UnZigZag(pc);
+  if (record.pc >= Globals::kMaxMemory) {
+    return false;
+  }
+  if (flags & kSameWord) {
+    word = block_words_[record.pc];
+  }
+  block_words_[record.pc] = word;
+  record.word = word;
+  record.opcode = (word >> 13) & 7;
+  record.flags = flags & 7;
+  record.address = TraceRecord::kNoAddress;
+  if (flags & kHasAddress) {
+    record.address = previous_.address + UnZigZag(address);
+  }
+  record.accum_before = previous_.accum_after + UnZigZag(accum_before);
+  record.accum_after = record.accum_before + UnZigZag(accum_change);
+  record.operand = PredictOperand(record, previous_) + UnZigZag(operand);
+
+  int previous_address = previous_.address;
+  previous_ = record;
+  if (!(flags & kHasAddress)) {
+    previous_.address = previous_address;
+  }
+  return true;
+}
+
+/******************************************************************************
+ * Function 'Next'.
+ * Read the next record.
+ *
+ * Parameter:
+ *   record - where to put the record
+ *
+ * Returns:
+ *   false at the end of the trace
+**/
+bool TraceReader::Next(TraceRecord& record) {
+  if (fp_ == NULL) {
+    return false;
+  }
+  if (has_lookahead_) {
+    record = lookahead_;
+    has_lookahead_ = false;
+    return true;
+  }
+  if (!is_compressed_) {
+    return fread(&record, sizeof(record), 1, fp_) == 1;
+  }
+
+  while (block_records_left_ == 0) {
+    if (!this->ReadBlock()) {
+      return false;
+    }
+  }
+  if (!this->DecodeRecord(record)) {
+    return false;
+  }
+  --block_records_left_;
+  return true;
+}
+
+/******************************************************************************
+ * Function 'Open'.
+ * Open a trace, compressed or not, and read its header.
+ *
+ * Parameter:
+ *   filename - the name of the trace file
+ *
+ * Returns:
+ *   false if the file can't be read or is not a trace
+**/
+bool TraceReader::Open(string filename) {
+  this->Close();
+  fp_ = fopen(filename.c_str(), "rb");
+  if (fp_ == NULL) {
+    return false;
+  }
+
+  char magic[4];
+  int32_t trace_level = 0;
+  int64_t log_offset = 0;
+  int32_t memory_size = 0;
+  if ((fread(magic, 1, 4, fp_) != 4) ||
+      ((memcmp(magic, TraceWriter::kMagic, 4) != 0) &&
+       (memcmp(magic, TraceWriter::kCompressedMagic, 4) != 0)) ||
+      (fread(&trace_level, sizeof(trace_level), 1, fp_) != 1) ||
+      (fread(&log_offset, sizeof(log_offset), 1, fp_) != 1) ||
+      (fread(&memory_size, sizeof(memory_size), 1, fp_) != 1) ||
+      (memory_size < 0)) {
+    this->Close();
+    return false;
+  }
+  is_compressed_ = (memcmp(magic, TraceWriter::kCompressedMagic, 4) == 0);
+  trace_level_ = trace_level;
+  log_offset_ = log_offset;
+
+  image_.clear();
+  for (int address = 0; address < memory_size; ++address) {
+    uint16_t word = 0;
+    if (fread(&word, sizeof(word), 1, fp_) != 1) {
+      this->Close();
+      return false;
+    }
+    image_.push_back(word);
+  }
+
+  records_offset_ = ftello(fp_);
+  block_records_left_ = 0;
+  has_lookahead_ = false;
+  index_.clear();
+  if (is_compressed_) {
+    this->ReadIndex();
+  }
+  return true;
+}
+
+/******************************************************************************
+ * Function 'ReadBlock'.
+ * Read the next block of a compressed trace.
+ *
+ * Returns:
+ *   false at the index or the end of the file
+**/
+bool TraceReader::ReadBlock() {
+  if (fgetc(fp_) != 'B') {
+    return false;
+  }
+
+  LONG first_index = 0;
+  LONG how_many = 0;
+  int method = 0;
+  LONG length = 0;
+  LONG stored_length = 0;
+  if (!Varint::Read(fp_, first_index) || !Varint::Read(fp_, how_many) ||
+      ((method = fgetc(fp_)) == EOF) || !Varint::Read(fp_, length) ||
+      !Varint::Read(fp_, stored_length)) {
+    return false;
+  }
+  if ((how_many < 0) || (how_many > TraceWriter::kBlockRecords) ||
+      (length < 0) || (length > kMaxBlockBytes) ||
+      (stored_length < 0) || (stored_length > length)) {
+    return false;
+  }
+
+  vector<char> stored(stored_length);
+  if ((stored_length > 0) &&
+      (fread(&stored[0], 1, stored_length, fp_) !=
+       static_cast<size_t>(stored_length))) {
+    return false;
+  }
+  if (method == 1) {
+    if (!Decompress(stored, length, block_)) {
+      return false;
+    }
+  } else {
+    block_.swap(stored);
+  }
+
+  memset(&previous_, 0, sizeof(previous_));
+  previous_.instruction_index = first_index - 1;
+  block_words_.assign(Globals::kMaxMemory, -1);
+  block_used_ = 0;
+  block_records_left_ = how_many;
+  return true;
+}
+
+/******************************************************************************
+ * Function 'ReadIndex'.
+ * Read the index of the blocks of a compressed trace. If the trace has no
+ * index, because the run did not end cleanly, then one is made by reading
+ * the headers of the blocks.
+**/
+void TraceReader::ReadIndex() {
+  int64_t index_offset = 0;
+  char magic[4];
+  if ((fseeko(fp_, -12, SEEK_END) == 0) &&
+      (fread(&index_offset, sizeof(index_offset), 1, fp_) == 1) &&
+      (fread(magic, 1, 4, fp_) == 4) &&
+      (memcmp(magic, kIndexMagic, 4) == 0) &&
+      (fseeko(fp_, index_offset, SEEK_SET) == 0) && (fgetc(fp_) == 'I')) {
+    LONG how_many = 0;
+    Varint::Read(fp_, how_many);
+    for (LONG i = 0; i < how_many; ++i) {
+      TraceIndexEntry entry;
+      if (!Varint::Read(fp_, entry.first_index) ||
+          !Varint::Read(fp_, entry.file_offset)) {
+        break;
+      }
+      index_.push_back(entry);
+    }
+  } else {
+    fseeko(fp_, records_offset_, SEEK_SET);
+    while (true) {
+      TraceIndexEntry entry;
+      entry.file_offset = ftello(fp_);
+      LONG how_many = 0;
+      LONG length = 0;
+      LONG stored_length = 0;
+      if ((fgetc(fp_) != 'B') || !Varint::Read(fp_, entry.first_index) ||
+          !Varint::Read(fp_, how_many) || (fgetc(fp_) == EOF) ||
+          !Varint::Read(fp_, length) || !Varint::Read(fp_, stored_length) ||
+          (stored_length < 0) || (stored_length > kMaxBlockBytes) ||
+          (fseeko(fp_, stored_length, SEEK_CUR) != 0)) {
+        break;
+      }
+      index_.push_back(entry);
+    }
+  }
+
+  fseeko(fp_, records_offset_, SEEK_SET);
+}
+
+/******************************************************************************
+ * Function 'SeekTo'.
+ * Position the trace so that 'Next' reads the record of an instruction.
+ *
+ * Uncompressed records are all the same size, so this is one seek. For a
+ * compressed trace the index gives the block, and only that block is
+ * decoded up to the record.
+ *
+ * Parameter:
+ *   instruction_index - the index of the instruction
+ *
+ * Returns:
+ *   false if the trace ends before that instruction
+**/
+bool TraceReader::SeekTo(LONG instruction_index) {
+  if (fp_ == NULL) {
+    return false;
+  }
+  has_lookahead_ = false;
+  block_records_left_ = 0;
+
+  if (!is_compressed_) {
+    TraceRecord first;
+    fseeko(fp_, records_offset_, SEEK_SET);
+    if (fread(&first, sizeof(first), 1, fp_) != 1) {
+      return false;
+    }
+    LONG skip = instruction_index - first.instruction_index;
+    if (skip < 0) skip = 0;
+    fseeko(fp_, records_offset_ + skip * sizeof(TraceRecord), SEEK_SET);
+  } else {
+    LONG offset = records_offset_;
+    for (auto iter = index_.begin(); iter != index_.end(); ++iter) {
+      if (iter->first_index > instruction_index) break;
+      offset = iter->file_offset;
+    }
+    fseeko(fp_, offset, SEEK_SET);
+  }
+
+  TraceRecord record;
+  while (this->Next(record)) {
+    if (record.instruction_index >= instruction_index) {
+      lookahead_ = record;
+      has_lookahead_ = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+/******************************************************************************
+ * Class 'Varint' for unsigned integers written as varints: seven bits to a
+ * byte, low bits first, with the high bit set on every byte but the last.
+ * Both the trace and the replay file use them.
+ *
+ * A 64 bit number takes at most ten bytes, and the tenth has only one bit
+ * of the number, so a longer varint or a fuller tenth byte is refused.
+ * The bits are put together as unsigned, which can't overflow.
+**/
+
+/******************************************************************************
+ * Function 'AddByte'.
+ * Add one byte of a varint to the bits read so far.
+ *
+ * Parameters:
+ *   c - the byte
+ *   shift - where its seven bits go
+ *   bits - the bits so far
+ *
+ * Returns:
+ *   false if the byte can't be part of a 64 bit varint
+**/
+bool Varint::AddByte(int c, int shift, uint64_t& bits) {
+  if ((shift == 63) && ((c & ~1) != 0)) {
+    return false;
+  }
+  bits |= static_cast<uint64_t>(c & 127) << shift;
+  return true;
+}
+
+/******************************************************************************
+ * Function 'Get'.
+ * Take one varint from a buffer.
+ *
+ * Parameters:
+ *   in - the buffer
+ *   position - where the varint starts, moved past it
+ *   value - the number read
+ *
+ * Returns:
+ *   false if the buffer ends first or the varint is too long
+**/
+bool Varint::Get(const vector<char>& in, UINT& position, LONG& value) {
+  uint64_t bits = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (position >= in.size()) return false;
+    int c = static_cast<unsigned char>(in[position++]);
+    if (!Varint::AddByte(c, shift, bits)) return false;
+    if ((c & 128) == 0) {
+      value = static_cast<LONG>(bits);
+      return true;
+    }
+  }
+  return false;
+}
+
+/******************************************************************************
+ * Function 'Put'.
+ * Append one varint to a buffer.
+**/
+void Varint::Put(vector<char>& out, LONG value) {
+  uint64_t bits = static_cast<uint64_t>(value);
+  while (bits >= 128) {
+    out.push_back(static_cast<char>((bits & 127) | 128));
+    bits >>= 7;
+  }
+  out.push_back(static_cast<char>(bits));
+}
+
+/******************************************************************************
+ * Function 'Read'.
+ * Read one varint from a file.
+ *
+ * Returns:
+ *   false if the file ends first or the varint is too long
+**/
+bool Varint::Read(FILE* fp, LONG& value) {
+  uint64_t bits = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int c = fgetc(fp);
+    if ((c == EOF) || !Varint::AddByte(c, shift, bits)) return false;
+    if ((c & 128) == 0) {
+      value = static_cast<LONG>(bits);
+      return true;
+    }
+  }
+  return false;
+}
+
+/******************************************************************************
+ * Function 'Write'.
+ * Write one varint to a file.
+**/
+void Varint::Write(FILE* fp, LONG value) {
+  uint64_t bits = static_cast<uint64_t>(value);
+  while (bits >= 128) {
+    fputc(static_cast<int>((bits & 127) | 128), fp);
+    bits >>= 7;
+  }
+  fputc(static_cast<int>(bits), fp);
+}
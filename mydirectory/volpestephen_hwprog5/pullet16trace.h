@@ -0,0 +1,200 @@
+/****************************************************************
+ * Header file for the Pullet16 binary execution trace.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+#ifndef TRACE_H
+#define TRACE_H
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "../../Utilities/utils.h"
+
+#include "globals.h"
+
+/******************************************************************************
+ * Varints for the trace and the replay file; see 'pullet16trace.cc'.
+**/
+class Varint {
+  public:
+    static bool Get(const vector<char>& in, UINT& position, LONG& value);
+    static void Put(vector<char>& out, LONG value);
+    static bool Read(FILE* fp, LONG& value);
+    static void Write(FILE* fp, LONG value);
+
+  private:
+    static bool AddByte(int c, int shift, uint64_t& bits);
+};
+
+/******************************************************************************
+ * One executed instruction. Every record is the same 24 bytes, written in
+ * the byte order of the host.
+ *
+ * 'operand' is the word that a memory instruction read, or for STC the
+ * word it stored. 'address' is the effective address after indirection,
+ * or 'kNoAddress' if the instruction used none or crashed finding it.
+**/
+struct TraceRecord {
+  static const int kNoAddress = 0xFFFF;
+
+  static const int kIndirect = 1;
+  static const int kFaulted = 2;
+  static const int kBranchTaken = 4;
+
+  int32_t instruction_index;
+  int32_t accum_before;
+  int32_t accum_after;
+  int32_t operand;
+  uint16_t pc;
+  uint16_t word;
+  uint16_t address;
+  uint8_t opcode;
+  uint8_t flags;
+};
+
+/******************************************************************************
+ * Where each block of a compressed trace starts, for random access.
+**/
+struct TraceIndexEntry {
+  LONG first_index;
+  LONG file_offset;
+};
+
+class TraceWriter {
+  public:
+    static const char kMagic[];
+    static const char kCompressedMagic[];
+    static const int kBufferSize = 1 << 20;
+    static const int kBlockRecords = 4096;
+
+    static const int kCompressNone = 0;
+    static const int kCompressDelta = 1;
+    static const int kCompressBlock = 2;
+
+    TraceWriter();
+    virtual ~TraceWriter();
+
+    void SetCompression(int compression);
+
+    /**************************************************************************
+     * Function 'Append'.
+     * Add one record to the buffer, writing the buffer out when it is full.
+     * This is on the path of every instruction, so it is inline.
+    **/
+    void Append(const TraceRecord& record) {
+      if (compression_ != kCompressNone) {
+        this->EncodeRecord(record);
+        return;
+      }
+      if (buffer_used_ + sizeof(TraceRecord) > buffer_.size()) {
+        this->Flush();
+      }
+      memcpy(&buffer_[buffer_used_], &record, sizeof(TraceRecord));
+      buffer_used_ += sizeof(TraceRecord);
+    }
+
+    void Close();
+    void Flush();
+    bool Open(string filename, int trace_level, LONG log_offset,
+              const vector<int>& image);
+
+  private:
+    FILE* fp_;
+    vector<char> buffer_;
+    UINT buffer_used_;
+
+    int compression_;
+    int block_count_;
+    LONG block_first_index_;
+    TraceRecord previous_;
+    vector<int> block_words_;
+    vector<TraceIndexEntry> index_;
+
+    void EncodeRecord(const TraceRecord& record);
+    void WriteBlock();
+};
+
+class FlightRecorder {
+  public:
+    static const int kDefaultSize = 64;
+
+    FlightRecorder();
+    virtual ~FlightRecorder();
+
+    int GetSize() const;
+    void SetSize(int size);
+
+    /**************************************************************************
+     * Function 'IsOn'.
+    **/
+    bool IsOn() const {
+      return !ring_.empty();
+    }
+
+    /**************************************************************************
+     * Function 'Append'.
+     * Record one instruction, overwriting the oldest once the ring is full.
+     * This is on the path of every instruction, so it is inline.
+    **/
+    void Append(const TraceRecord& record) {
+      ring_[next_] = record;
+      if (++next_ == ring_.size()) {
+        next_ = 0;
+      }
+      ++how_many_;
+    }
+
+    vector<TraceRecord> GetRecords() const;
+
+  private:
+    vector<TraceRecord> ring_;
+    UINT next_;
+    LONG how_many_;
+};
+
+class TraceReader {
+  public:
+    TraceReader();
+    virtual ~TraceReader();
+
+    const vector<int>& GetImage() const;
+    LONG GetLogOffset() const;
+    int GetTraceLevel() const;
+
+    void Close();
+    bool Next(TraceRecord& record);
+    bool Open(string filename);
+    bool SeekTo(LONG instruction_index);
+
+  private:
+    FILE* fp_;
+    bool is_compressed_;
+    int trace_level_;
+    LONG log_offset_;
+    LONG records_offset_;
+    vector<int> image_;
+
+    vector<char> block_;
+    UINT block_used_;
+    LONG block_records_left_;
+    TraceRecord previous_;
+    vector<int> block_words_;
+    vector<TraceIndexEntry> index_;
+
+    bool has_lookahead_;
+    TraceRecord lookahead_;
+
+    bool DecodeRecord(TraceRecord& record);
+    bool ReadBlock();
+    void ReadIndex();
+};
+#endif
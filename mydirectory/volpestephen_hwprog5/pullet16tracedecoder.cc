@@ -0,0 +1,263 @@
+#include "pullet16tracedecoder.h"
+
+/******************************************************************************
+ *3456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
+ * Class 'TraceDecoder' for turning a binary trace back into the text log.
+ *
+ * The trace may be compressed or not; 'TraceReader' reads either.
+ *
+ * A run traced in binary leaves a text log with only the lines that are
+ * not instruction trace: the 'Main' lines, the machine after loading,
+ * error messages, and the timeout. The decoder puts the text of every
+ * record at the point in that log where the run started, which gives the
+ * same bytes that the text trace would have written. A run on several
+ * cores differs only in the 'CORE' lines, which are not recorded, and in
+ * that a core that times out before the others has its 'PROGRAM TIMED
+ * OUT' after all of the records.
+ *
+ * The records hold everything the text of an instruction needs, so only
+ * the full dump after each instruction needs the decoder to keep a copy
+ * of memory, which it starts from the image in the trace header and
+ * changes at every STC.
+ *
+ * The lines themselves are laid out by 'LogFormat', the same as
+ * 'Interpreter' lays them out as it runs.
+ *
+ * A trace may be damaged or edited, so a record is checked before any of
+ * it is used, and a bad one ends the decoding as a bad header does.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+**/
+
+/******************************************************************************
+ * Whether a record could have been written by 'Interpreter': the PC and
+ * any address are in memory, and the opcode is the one in the word.
+**/
+static bool IsValidRecord(const TraceRecord& record) {
+  return (record.pc < Globals::kMaxMemory) &&
+         (record.opcode == ((record.word >> 13) & 7)) &&
+         ((record.address == TraceRecord::kNoAddress) ||
+          (record.address < Globals::kMaxMemory));
+}
+
+/******************************************************************************
+ * The label of the location of each of the opcodes 0 through 6.
+**/
+static const char* const kLocationLabels[] = {
+  "BRANCH TO", "SUB FROM", "STORE TO", "AND WITH", "ADD FROM", "LOAD FROM",
+  "BRANCH TO"
+};
+
+/******************************************************************************
+ * Constructor
+**/
+TraceDecoder::TraceDecoder() {
+  memory_size_ = 0;
+}
+
+/******************************************************************************
+ * Destructor
+**/
+TraceDecoder::~TraceDecoder() {
+}
+
+/******************************************************************************
+ * General functions.
+**/
+
+/******************************************************************************
+ * Function 'Decode'.
+ * Regenerate the full text log of a run traced in binary.
+ *
+ * Parameters:
+ *   trace_filename - the binary trace
+ *   log_filename - the text log written during the run
+ *   decoded_filename - the file for the regenerated log
+ *
+ * Returns:
+ *   false if either input can't be read or the trace is not a trace or
+ *   has a bad record
+**/
+bool TraceDecoder::Decode(string trace_filename, string log_filename,
+                          string decoded_filename) {
+  TraceReader reader;
+  if (!reader.Open(trace_filename) ||
+      (static_cast<int>(reader.GetImage().size()) > Globals::kMaxMemory)) {
+    return false;
+  }
+  int trace_level = reader.GetTraceLevel();
+  LONG log_offset = reader.GetLogOffset();
+
+  memory_size_ = reader.GetImage().size();
+  memory_.assign(Globals::kMaxMemory, 0);
+  copy(reader.GetImage().begin(), reader.GetImage().end(), memory_.begin());
+
+  ifstream log_stream(log_filename.c_str(), ios::binary);
+  if (!log_stream) {
+    return false;
+  }
+  stringstream log_text;
+  log_text << log_stream.rdbuf();
+  string log = log_text.str();
+  if (log_offset > static_cast<LONG>(log.size())) {
+    return false;
+  }
+
+  ofstream out_stream(decoded_filename.c_str(), ios::binary);
+  out_stream << log.substr(0, log_offset);
+
+  TraceRecord record;
+  while ((trace_level >= 1) && reader.Next(record)) {
+    if (!IsValidRecord(record)) {
+      return false;
+    }
+    this->WriteRecord(record, out_stream);
+    if (record.flags & TraceRecord::kFaulted) {
+      continue;
+    }
+
+    if ((record.opcode == 2) && (record.address != TraceRecord::kNoAddress)) {
+      memory_.at(record.address) = record.operand;
+    }
+
+    if (trace_level >= 2) {
+      int pc = record.pc;
+      if (record.flags & TraceRecord::kBranchTaken) {
+        pc = record.address - 1;
+      } else if ((record.opcode == 7) && ((record.word & 4095) == 2)) {
+        pc = kPCForStop;
+      }
+      out_stream << "MACHINE IS NOW" << endl;
+      this->WriteState(pc, record.accum_after, out_stream);
+      out_stream << endl << endl;
+    } else {
+      out_stream << endl;
+    }
+  }
+
+  out_stream << log.substr(log_offset);
+  out_stream.close();
+
+  return true;
+}
+
+/******************************************************************************
+ * Function 'Show'.
+ * Write the instruction-level text of some of the records of a trace,
+ * going straight to the first one with 'TraceReader::SeekTo'.
+ *
+ * Parameters:
+ *   trace_filename - the binary trace
+ *   first_index - the index of the first instruction to show
+ *   how_many - the number of instructions to show
+ *   out_stream - where to write the text
+ *
+ * Returns:
+ *   false if the trace can't be read or has a bad record
+**/
+bool TraceDecoder::Show(string trace_filename, LONG first_index,
+                        LONG how_many, ostream& out_stream) {
+  TraceReader reader;
+  if (!reader.Open(trace_filename)) {
+    return false;
+  }
+
+  TraceRecord record;
+  if (!reader.SeekTo(first_index)) {
+    return true;
+  }
+  for (LONG count = 0; (count < how_many) && reader.Next(record); ++count) {
+    if (!IsValidRecord(record)) {
+      return false;
+    }
+    this->WriteRecord(record, out_stream);
+    out_stream << endl;
+  }
+  return true;
+}
+
+/******************************************************************************
+ * Function 'WriteRecord'.
+ * Write the instruction-level text of one record, without the machine
+ * dump and blank line that follow it.
+ *
+ * For a record of an instruction that crashed, this stops where the error
+ * message is written.
+ *
+ * Parameters:
+ *   record - the record of the instruction
+ *   out_stream - where to write the text
+**/
+void TraceDecoder::WriteRecord(const TraceRecord& record,
+                               ostream& out_stream) const {
+  char word_bits[Utils::kFormatBufferSize];
+  globals_.DecToBitString(record.word, 16, word_bits);
+  string opcode(word_bits, 3);
+  string addr(word_bits + 3, 1);
+  string target(word_bits + 4);
+  LogFormat::WriteInterpret(out_stream, record.pc, opcode, addr, target);
+
+  int location = record.word & 4095;
+  if (record.opcode == 7) {
+    LogFormat::WriteSystem(out_stream, location);
+    if (location == LogFormat::kWRT) {
+      char bits[Utils::kFormatBufferSize];
+      globals_.DecToBitString(record.accum_before, 16, bits);
+      char line[64];
+      LogFormat::OutputInto(line,
+                            this->TwosComplementInteger(record.accum_before),
+                            bits);
+      out_stream << line << "\n";
+    }
+    return;
+  }
+
+  LogFormat::WriteExecute(out_stream, record.opcode, addr, target);
+  if ((record.flags & TraceRecord::kFaulted) ||
+      ((record.opcode == 0) && !(record.flags & TraceRecord::kBranchTaken))) {
+    return;
+  }
+  LogFormat::WriteLocation(out_stream, kLocationLabels[record.opcode],
+                           location, (record.flags & TraceRecord::kIndirect),
+                           record.address);
+  if ((record.opcode >= 1) && (record.opcode <= 5)) {
+    char bits[Utils::kFormatBufferSize];
+    globals_.DecToBitString(record.operand, 16, bits);
+    LogFormat::WriteValue(out_stream, record.opcode, bits,
+                          this->TwosComplementInteger(record.operand));
+  }
+}
+
+/******************************************************************************
+ * Function 'WriteState'.
+ * Write the machine dump that 'Interpreter::ToString' gives.
+ *
+ * Parameters:
+ *   pc - the program counter
+ *   accum - the accumulator
+ *   out_stream - where to write the dump
+**/
+void TraceDecoder::WriteState(int pc, int accum, ostream& out_stream) const {
+  char bits[Utils::kFormatBufferSize];
+  globals_.DecToBitString(accum, 16, bits);
+  char line[LogFormat::kMemoryLineSize];
+  int length = LogFormat::StateHeadInto(line, pc,
+                                        this->TwosComplementInteger(accum),
+                                        bits);
+  out_stream.write(line, length);
+
+  for (int outersub = 0; outersub < memory_size_; outersub += 4) {
+    length = LogFormat::MemoryLineInto(line, outersub, &memory_[outersub],
+                                       min(4, memory_size_ - outersub));
+    out_stream.write(line, length);
+  }
+}
+
+/******************************************************************************
+ * Function 'TwosComplementInteger'.
+ * The same conversion as 'Interpreter::TwosComplementInteger'.
+**/
+int TraceDecoder::TwosComplementInteger(int what) const {
+  return (what > 32768) ? what - 65536 : what;
+}
@@ -0,0 +1,49 @@
+/****************************************************************
+ * Header file for the Pullet16 binary trace decoder.
+ *
+ * Author: Stephen Volpe
+ * Date: 19 October 2026
+ *
+**/
+
+#ifndef TRACEDECODER_H
+#define TRACEDECODER_H
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "../../Utilities/utils.h"
+
+#include "globals.h"
+#include "pullet16logformat.h"
+#include "pullet16trace.h"
+
+class TraceDecoder {
+  public:
+    TraceDecoder();
+    virtual ~TraceDecoder();
+
+    bool Decode(string trace_filename, string log_filename,
+                string decoded_filename);
+    bool Show(string trace_filename, LONG first_index, LONG how_many,
+              ostream& out_stream);
+    void WriteRecord(const TraceRecord& record, ostream& out_stream) const;
+
+  private:
+    static const int kPCForStop = 7777;
+
+    int memory_size_;
+    vector<int> memory_;
+    Globals globals_;
+
+    int TwosComplementInteger(int what) const;
+    void WriteState(int pc, int accum, ostream& out_stream) const;
+};
+#endif